@@ -22,9 +22,12 @@
 #pragma once
 
 #include "IComposite.h"
+#include "PluginQuality.h"
+#include "SilenceDetector.h"
 #include "SynthFilter.h"
 #include "AudioMath.h"
 #include "UtilityFilters.h"
+#include "LookupTable.h"
 #include <memory>
 #include <vector>
 #include <time.h>
@@ -84,6 +87,7 @@ public:
         sampleRate = rate;
         sampleTime = 1.0f / rate;
         maxFreq = std::min (rate / 2.0f, 20000.0f);
+        silence.setSampleRate (rate);
     }
 
     // must be called after setSampleRate
@@ -95,13 +99,16 @@ public:
             f.setUseNonLinearProcessing (true);
             f.setType (sspo::MoogLadderFilter<float_4>::types()[0]);
             f.setUseOversample (true);
-            float_4 asym = float_4 (1.0f);
-            f.nonLinearProcess = [asym] (float_4 in, float_4 drive) {
-                return rack::simd::ifelse (in > float_4 (0),
-                                           (atan (drive * in) / atan (drive)),
-                                           (atan ((drive * in) / asym) / atan (drive / asym)));
+            const auto* table = &saturationTable();
+            f.nonLinearProcess = [table] (float_4 in, float_4 drive) {
+                return sspo::AudioMath::LookupTable::process (*table, in, drive);
             }; //end of lambda
         }
+        useOversample = true;
+        currentType = -1;
+        controls.assign (SIMD_MAX_CHANNELS, GroupControls());
+        controlCounter = 0;
+        controlChannels = 0;
 
         sspo::AudioMath::defaultGenerator.seed (time (NULL));
     }
@@ -115,6 +122,8 @@ public:
         DRIVE_CV_ATTENUVERTER_PARAM,
         DRIVE_PARAM,
         MODE_PARAM,
+        CONTROL_RATE_PARAM,
+        QUALITY_OVERRIDE_PARAM,
         NUM_PARAMS
     };
 
@@ -150,68 +159,186 @@ public:
     float sampleRate = 1.0f;
     float sampleTime = 1.0f;
     std::vector<sspo::MoogLadderFilter<float_4>> filters;
+    SilenceDetector silence;
     void step() override;
+
+    /// the ladder's saturation, atan (drive * in) / atan (drive), shared by every instance.
+    /// The filter input stays within +-3 for +-10V in, past the table the curve is held at its edge.
+    static const sspo::AudioMath::LookupTable::Table2D<float>& saturationTable()
+    {
+        static const auto table = sspo::AudioMath::LookupTable::makeTable2D<float> (
+            -saturationRange, saturationRange, 1.0f / 128.0f, 1.0f, maxDrive, 0.25f, [] (const float in, const float drive) {
+                return std::atan (drive * in) / std::atan (drive);
+            });
+        return table;
+    }
+
+private:
+    static constexpr float saturationRange = 4.0f;
+
+    /// the controls last given to each group's filter, in octaves before the pow2,
+    /// the coefficients are only recalculated when one of these changes
+    struct GroupControls
+    {
+        float_4 pitch = -100.0f;
+        float_4 resonance = 0.0f;
+        float_4 drive = 0.0f;
+    };
+    std::vector<GroupControls> controls;
+
+    /// frequency, resonance and drive for one group, run every controlDivision samples
+    void stepControls (int group);
+
+    /// The drive's small signal gain is in the feedback loop, so a high drive and resonance together
+    /// let the bootstrap noise start the ladder ringing with no input, the lowest found is 1.9 at a drive of 4.
+    /// The filter can make sound then, so it is kept out of idle.
+    static constexpr float selfOscillationResonance = 1.5f;
+    static constexpr float selfOscillationDrive = 3.0f;
+    bool canSelfOscillate();
+
+    int controlCounter = 0;
+    int controlDivision = 4;
+    int controlChannels = 0;
+
+    /// the control rate and the ladder's oversampling, from the quality unless the rate is set in the menu
+    void readQuality();
+    bool useOversample = true;
 };
 
+template <class TBase>
+inline void AmburghComp<TBase>::readQuality()
+{
+    const auto level = sspo::PluginQuality::resolve (TBase::params[QUALITY_OVERRIDE_PARAM].getValue());
+    const auto rateParam = static_cast<int> (TBase::params[CONTROL_RATE_PARAM].getValue());
+    controlDivision = rateParam >= 1 ? rateParam : sspo::PluginQuality::select (level, 16, 4, 1);
+
+    const auto oversample = level != sspo::PluginQuality::Level::ECO;
+    if (oversample != useOversample)
+    {
+        useOversample = oversample;
+        for (auto& f : filters)
+            f.setUseOversample (oversample);
+    }
+}
+
+template <class TBase>
+inline void AmburghComp<TBase>::stepControls (int group)
+{
+    const auto c = group * 4;
+    float_4 pitch = TBase::params[FREQUENCY_PARAM].getValue() * 10.0f - 5.0f;
+    if (TBase::inputs[VOCT_INPUT].isConnected())
+        pitch += TBase::inputs[VOCT_INPUT].template getPolyVoltageSimd<float_4> (c);
+    if (TBase::inputs[FREQ_CV_INPUT].isConnected())
+    {
+        pitch += TBase::inputs[FREQ_CV_INPUT].template getPolyVoltageSimd<float_4> (c)
+                 * TBase::params[FREQUENCY_CV_ATTENUVERTER_PARAM].getValue();
+    }
+
+    float_4 resonance = TBase::params[RESONANCE_PARAM].getValue()
+                        + TBase::inputs[RESONANCE_CV_INPUT].template getPolyVoltageSimd<float_4> (c)
+                              * (TBase::params[RESONANCE_CV_ATTENUVERTER_PARAM].getValue() * maxRes / 5.0f);
+    resonance = rack::simd::clamp (resonance, float_4 (0.5f), float_4 (maxRes));
+
+    float_4 drive = TBase::params[DRIVE_PARAM].getValue()
+                    + TBase::inputs[DRIVE_CV_INPUT].template getPolyVoltageSimd<float_4> (c)
+                          * (TBase::params[DRIVE_CV_ATTENUVERTER_PARAM].getValue() * maxDrive / 5.0f);
+    drive = rack::simd::clamp (drive, float_4 (1.0f), float_4 (maxDrive));
+
+    auto& last = controls[group];
+    const auto changed = (pitch != last.pitch) | (resonance != last.resonance) | (drive != last.drive);
+    if (rack::simd::movemask (changed) == 0)
+        return;
+    last.pitch = pitch;
+    last.resonance = resonance;
+    last.drive = drive;
+
+    float_4 frequency = dsp::FREQ_C4 * rack::simd::pow (2.0f, pitch);
+    frequency = rack::simd::clamp (frequency, float_4 (0.0f), float_4 (maxFreq));
+    filters[group].setParameters (frequency, resonance, drive, float_4 (0.5f), sampleRate);
+}
+
+template <class TBase>
+inline bool AmburghComp<TBase>::canSelfOscillate()
+{
+    const auto resonance = TBase::params[RESONANCE_PARAM].getValue()
+                           + SilenceDetector::peak (TBase::inputs[RESONANCE_CV_INPUT])
+                                 * std::abs (TBase::params[RESONANCE_CV_ATTENUVERTER_PARAM].getValue()) * maxRes / 5.0f;
+    const auto drive = TBase::params[DRIVE_PARAM].getValue()
+                       + SilenceDetector::peak (TBase::inputs[DRIVE_CV_INPUT])
+                             * std::abs (TBase::params[DRIVE_CV_ATTENUVERTER_PARAM].getValue()) * maxDrive / 5.0f;
+    return resonance >= selfOscillationResonance && drive >= selfOscillationDrive;
+}
+
 template <class TBase>
 inline void AmburghComp<TBase>::step()
 {
     auto channels = std::max (TBase::inputs[MAIN_INPUT].getChannels(),
                               TBase::inputs[VOCT_INPUT].getChannels());
     channels = std::max (channels, 1);
-    auto freqParam = TBase::params[FREQUENCY_PARAM].getValue();
-    auto resParam = TBase::params[RESONANCE_PARAM].getValue();
-    auto driveParam = TBase::params[DRIVE_PARAM].getValue();
-    auto modeParam = static_cast<int> (TBase::params[MODE_PARAM].getValue());
-    auto freqAttenuverterParam = TBase::params[FREQUENCY_CV_ATTENUVERTER_PARAM].getValue();
-    auto resAttenuverterParam = TBase::params[RESONANCE_CV_ATTENUVERTER_PARAM].getValue();
-    auto driveAttenuverterParam = TBase::params[DRIVE_CV_ATTENUVERTER_PARAM].getValue();
+
+    // the bootstrap noise is skipped while idle, so turning the resonance and drive up wakes it
+    const auto selfOscillating = canSelfOscillate();
+    if (selfOscillating)
+        silence.keepAwake();
+    else if (silence.isIdle() && ! silence.wake (SilenceDetector::peak (TBase::inputs[MAIN_INPUT])))
+    {
+        SilenceDetector::writeSilence (TBase::outputs[MAIN_OUTPUT], channels);
+        return;
+    }
+
+    // every group changes type together
+    const auto modeParam = clamp (static_cast<int> (TBase::params[MODE_PARAM].getValue()), 0, typeCount - 1);
+    if (currentType != modeParam)
+    {
+        currentType = modeParam;
+        for (auto& f : filters)
+            f.setType (sspo::MoogLadderFilter<float_4>::types()[currentType]);
+    }
+
+    // new voices can't wait for the next control step
+    const auto controlStep = controlCounter == 0 || channels != controlChannels;
+    if (controlStep)
+    {
+        readQuality();
+        controlChannels = channels;
+    }
+    if (++controlCounter >= controlDivision)
+        controlCounter = 0;
 
     auto noise = float_4 (1e-6f * (2.0f * sspo::AudioMath::rand01() - 1.0f));
-    freqParam = freqParam * 10.0f - 5.0f;
 
     for (auto c = 0; c < channels; c += 4)
     {
+        const auto group = c / 4;
+        if (controlStep)
+            stepControls (group);
+
         auto in = TBase::inputs[MAIN_INPUT].template getPolyVoltageSimd<float_4> (c);
         // Add -120dB noise to bootstrap self-oscillation
         in += noise;
 
-        auto frequency = float_4 (freqParam);
-        if (TBase::inputs[VOCT_INPUT].isConnected())
-            frequency += float_4 (TBase::inputs[VOCT_INPUT].template getPolyVoltageSimd<float_4> (c));
-        if (TBase::inputs[FREQ_CV_INPUT].isConnected())
-        {
-            frequency += (TBase::inputs[FREQ_CV_INPUT].template getPolyVoltageSimd<float_4> (c)
-                          * freqAttenuverterParam);
-        }
-        frequency = dsp::FREQ_C4 * rack::simd::pow (2.0f, frequency);
-
-        frequency = rack::simd::clamp (frequency, float_4 (0.0f), float_4 (maxFreq));
+        auto out = filters[group].process (in / 10.0f) * 10.0f;
 
-        auto resonance = float_4 (resParam);
-        resonance += (float_4 (TBase::inputs[RESONANCE_CV_INPUT].template getPolyVoltageSimd<float_4> (c)) / 5.0f)
-                     * resAttenuverterParam * maxRes;
-        resonance = rack::simd::clamp (resonance, float_4 (0.5f), float_4 (maxRes));
-
-        auto drive = float_4 (driveParam);
-        drive += (TBase::inputs[DRIVE_CV_INPUT].template getPolyVoltageSimd<float_4> (c) / 5.0f)
-                 * driveAttenuverterParam * maxDrive;
-        drive = rack::simd::clamp (drive, float_4 (1.0f), float_4 (maxDrive));
-
-        if (currentType != modeParam)
+        // a non finite lane would stay in the feedback loop, so the group's filter starts again
+        const float_4 finite = rack::simd::abs (out) < INFINITY;
+        if (rack::simd::movemask (finite) != 0xf)
         {
-            currentType = modeParam;
-            filters[c / 4].setType (sspo::MoogLadderFilter<float_4>::types()[currentType]);
+            filters[group].reset();
+            out = rack::simd::ifelse (finite, out, 0.0f);
         }
 
-        filters[c / 4].setParameters (frequency, resonance, drive, float_4 (0.5f), sampleRate);
-
-        auto out = filters[c / 4].process (in / 10.0f) * 10.0f;
-        //out = std::isfinite (out) ? out : 0;
-
         TBase::outputs[MAIN_OUTPUT].setVoltageSimd (out, c);
     }
     TBase::outputs[MAIN_OUTPUT].setChannels (channels);
+
+    if (! selfOscillating
+        && silence.process (SilenceDetector::peak (TBase::inputs[MAIN_INPUT]), SilenceDetector::peak (TBase::outputs[MAIN_OUTPUT])))
+    {
+        for (auto& f : filters)
+            f.reset();
+        // the controls may move while idle, so waking up starts with a control step
+        controlChannels = 0;
+    }
 }
 
 template <class TBase>
@@ -249,6 +376,12 @@ IComposite::Config AmburghDescription<TBase>::getParam (int i)
         case AmburghComp<TBase>::MODE_PARAM:
             ret = { 0.0f, AmburghComp<TBase>::typeCount - 1, 0.0f, "Type", " ", 0.0f, 1.0f, 0.0f };
             break;
+        case AmburghComp<TBase>::CONTROL_RATE_PARAM:
+            ret = { 0.0f, 64.0f, 0.0f, "Control rate division", " samples", 0, 1, 0.0f };
+            break;
+        case AmburghComp<TBase>::QUALITY_OVERRIDE_PARAM:
+            ret = sspo::PluginQuality::overrideConfig();
+            break;
         default:
             assert (false);
     }
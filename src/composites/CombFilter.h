@@ -25,8 +25,14 @@
 #include "CircularBuffer.h"
 #include "HardLimiter.h"
 #include "LookupTable.h"
+#include "PluginQuality.h"
+#include "SilenceDetector.h"
+#include "UtilityFilters.h"
 #include "resampler.hpp"
 
+#include <array>
+#include <cmath>
+
 namespace rack
 {
     namespace engine
@@ -83,6 +89,12 @@ public:
         COMB_PARAM,
         FEEDBACK_CV_ATTENUVERTER_PARAM,
         FEEDBACK_PARAM,
+        BANK_COMBS_PARAM,
+        BANK_TUNING_PARAM,
+        MODE_PARAM,
+        LFO_RATE_PARAM,
+        LFO_DEPTH_PARAM,
+        QUALITY_OVERRIDE_PARAM,
         NUM_PARAMS
     };
     enum InputIds
@@ -97,6 +109,7 @@ public:
     enum OutputIds
     {
         MAIN_OUTPUT,
+        QUADRATURE_OUTPUT,
         NUM_OUTPUTS
     };
     enum LightIds
@@ -104,41 +117,128 @@ public:
         NUM_LIGHTS
     };
 
+    enum class Mode
+    {
+        COMB,
+        MODULATED_DELAY
+    };
+
+    /// pitch ratios for the combs in bank mode
+    enum class BankTuning
+    {
+        HARMONIC,
+        MAJOR,
+        MINOR,
+        INHARMONIC,
+        COUNT
+    };
+
     static constexpr float dcOutCutoff = 4.0f;
     float maxFreq = 20000;
     float sampleRate = 1;
     float samplePeriod = 1;
 
-    std::vector<CircularBuffer<float>> buffers;
-    std::vector<sspo::Compressor> limiters;
-    std::vector<dsp::RCFilter> dcOutFilters;
+    // one per group of four voices, a voice in each float_4 lane
+    static constexpr int maxGroups = PORT_MAX_CHANNELS / 4;
+    std::vector<InterleavedCircularBuffer> buffers;
+    std::vector<sspo::TCompressor<float_4>> limiters;
+    std::vector<sspo::DcBlocker<float_4>> dcOutFilters;
+
+    // bank mode, up to eight combs per voice, four combs in each float_4
+    static constexpr int maxBankCombs = 8;
+    static constexpr int bankGroups = maxBankCombs / 4;
+    std::vector<std::array<InterleavedCircularBuffer, bankGroups>> bankBuffers;
+    std::array<float_4, bankGroups> bankRatios;
+    std::array<float_4, bankGroups> bankFeedbacks;
+
+    /// pitch ratio to the voice and feedback scale of one comb in the bank
+    void setBankComb (int comb, float ratio, float feedback)
+    {
+        bankRatios[comb / 4][comb % 4] = ratio;
+        bankFeedbacks[comb / 4][comb % 4] = feedback;
+    }
+
+    void setBankTuning (BankTuning tuning)
+    {
+        static const float semitones[2][maxBankCombs] = { { 0.0f, 4.0f, 7.0f, 12.0f, 16.0f, 19.0f, 24.0f, 28.0f },
+                                                          { 0.0f, 3.0f, 7.0f, 12.0f, 15.0f, 19.0f, 24.0f, 27.0f } };
+        // modes of a free bar
+        static const float barRatios[maxBankCombs] = { 1.0f, 2.756f, 5.404f, 8.933f, 13.344f, 18.638f, 24.814f, 31.873f };
+
+        for (auto i = 0; i < maxBankCombs; ++i)
+        {
+            switch (tuning)
+            {
+                case BankTuning::MAJOR:
+                    setBankComb (i, std::pow (2.0f, semitones[0][i] / 12.0f), 1.0f);
+                    break;
+                case BankTuning::MINOR:
+                    setBankComb (i, std::pow (2.0f, semitones[1][i] / 12.0f), 1.0f);
+                    break;
+                case BankTuning::INHARMONIC:
+                    setBankComb (i, barRatios[i], 1.0f - 0.03f * i);
+                    break;
+                case BankTuning::HARMONIC:
+                default:
+                    setBankComb (i, i + 1.0f, 1.0f - 0.02f * i);
+                    break;
+            }
+        }
+        bankTuning = tuning;
+    }
+
+    // modulated delay mode, a sine lfo per voice sweeps the delay
+    static constexpr float delaySmoothingCutoff = 20.0f;
+    std::vector<float_4> lfoPhases;
+    /// the channel count the lfo phases were spread for
+    int lfoChannels = 0;
+    std::vector<float_4> smoothedDelays;
+    std::vector<sspo::DcBlocker<float_4>> quadratureDcOutFilters;
+    std::vector<sspo::TCompressor<float_4>> quadratureLimiters;
 
     void setSampleRate (float rate)
     {
         sampleRate = rate;
         samplePeriod = 1.0f / sampleRate;
+        delaySmoothing = 1.0f - std::exp (-2.0f * static_cast<float> (M_PI) * delaySmoothingCutoff / sampleRate);
+
+        for (auto& d : quadratureDcOutFilters)
+            d.setCutoff (sampleRate, dcOutCutoff);
+
+        for (auto& l : quadratureLimiters)
+            l.setSampleRate (sampleRate);
 
         maxFreq = std::min (20000.0f, sampleRate / 2.0f);
 
         for (auto& d : dcOutFilters)
-            d.setCutoffFreq (dcOutCutoff / sampleRate);
+            d.setCutoff (sampleRate, dcOutCutoff);
 
         for (auto& l : limiters)
             l.setSampleRate (sampleRate);
+
+        silence.setSampleRate (sampleRate);
     }
 
     // must be called after setSampleRate
     void init()
     {
-        buffers.resize (PORT_MAX_CHANNELS);
+        buffers.resize (maxGroups);
         for (auto& b : buffers)
             b.reset (4096);
 
-        dcOutFilters.resize (PORT_MAX_CHANNELS);
+        dcOutFilters.resize (maxGroups);
         for (auto& d : dcOutFilters)
-            d.setCutoffFreq (dcOutCutoff / sampleRate);
+            d.setCutoff (sampleRate, dcOutCutoff);
+
+        bankBuffers.resize (PORT_MAX_CHANNELS);
+        for (auto& voice : bankBuffers)
+        {
+            for (auto& b : voice)
+                b.reset (4096);
+        }
+        setBankTuning (BankTuning::HARMONIC);
 
-        limiters.resize (PORT_MAX_CHANNELS);
+        limiters.resize (maxGroups);
         for (auto& l : limiters)
         {
             l.setSampleRate (sampleRate);
@@ -146,54 +246,230 @@ public:
             l.threshold = -0.3f;
             l.ratio = 10.5f;
         }
+
+        lfoPhases.assign (maxGroups, float_4 (0.0f));
+        lfoChannels = 0;
+        smoothedDelays.assign (maxGroups, float_4 (0.0f));
+
+        quadratureDcOutFilters.resize (maxGroups);
+        for (auto& d : quadratureDcOutFilters)
+            d.setCutoff (sampleRate, dcOutCutoff);
+
+        quadratureLimiters = limiters;
     }
 
+    /// the feedback tail counts as output, so it rings out before processing stops
+    SilenceDetector silence;
+
     void step() override;
+
+private:
+    void stepComb (int channels);
+    float_4 processBank (int channel, float in, float frequency, float feedback, float comb, int combs);
+    void stepModulatedDelay (int channels);
+
+    float delaySmoothing = 1.0f;
+
+    /// Eco reads the modulated delay linearly, High reads the single comb with cubic interpolation too
+    sspo::PluginQuality::Level quality = sspo::PluginQuality::Level::NORMAL;
+
+    BankTuning bankTuning = BankTuning::HARMONIC;
 };
 
 template <class TBase>
 inline void CombFilterComp<TBase>::step()
 {
     auto channels = std::max (1, TBase::inputs[MAIN_INPUT].getChannels());
+    const auto modulatedDelay = static_cast<Mode> (TBase::params[MODE_PARAM].getValue()) == Mode::MODULATED_DELAY;
+
+    const auto inputPeak = SilenceDetector::peak (TBase::inputs[MAIN_INPUT]);
+    if (silence.isIdle() && ! silence.wake (inputPeak))
+    {
+        SilenceDetector::writeSilence (TBase::outputs[MAIN_OUTPUT], channels);
+        SilenceDetector::writeSilence (TBase::outputs[QUADRATURE_OUTPUT], modulatedDelay ? channels : 1);
+        return;
+    }
+
+    const auto level = sspo::PluginQuality::resolve (TBase::params[QUALITY_OVERRIDE_PARAM].getValue());
+    if (level != quality)
+    {
+        quality = level;
+        const auto limiterDivision = sspo::PluginQuality::select (quality, 8, 4, 2);
+        for (auto& l : limiters)
+            l.setDivision (limiterDivision);
+        for (auto& l : quadratureLimiters)
+            l.setDivision (limiterDivision);
+    }
+    if (modulatedDelay)
+        stepModulatedDelay (channels);
+    else
+        stepComb (channels);
+    silence.process (inputPeak,
+                     std::max (SilenceDetector::peak (TBase::outputs[MAIN_OUTPUT]),
+                               SilenceDetector::peak (TBase::outputs[QUADRATURE_OUTPUT])));
+}
+
+template <class TBase>
+inline void CombFilterComp<TBase>::stepComb (int channels)
+{
     auto freqParam = TBase::params[FREQUENCY_PARAM].getValue();
     auto freqAttenuverterParam = TBase::params[FREQUENCY_CV_ATTENUVERTER_PARAM].getValue();
     auto combParam = TBase::params[COMB_PARAM].getValue();
     auto combAttenuverterParam = TBase::params[COMB_CV_ATTENUVERTER_PARAM].getValue();
     auto feedbackParam = TBase::params[FEEDBACK_PARAM].getValue();
     auto feedbackAttenuverterParam = TBase::params[FEEDBACK_CV_ATTENUVERTER_PARAM].getValue();
+    auto combs = clamp (static_cast<int> (TBase::params[BANK_COMBS_PARAM].getValue()), 1, maxBankCombs);
+    auto tuning = static_cast<BankTuning> (clamp (static_cast<int> (TBase::params[BANK_TUNING_PARAM].getValue()), 0, static_cast<int> (BankTuning::COUNT) - 1));
+    if (tuning != bankTuning)
+        setBankTuning (tuning);
+    const auto cubic = quality == sspo::PluginQuality::Level::HIGH;
 
-    for (auto c = 0; c < channels; ++c)
+    for (auto c = 0; c < channels; c += 4)
     {
-        auto in = TBase::inputs[MAIN_INPUT].getPolyVoltage (c) / 5.0f;
+        auto g = c / 4;
+        float_4 in = TBase::inputs[MAIN_INPUT].template getPolyVoltageSimd<float_4> (c) / 5.0f;
 
-        auto frequency = freqParam;
-        frequency += TBase::inputs[VOCT_INPUT].getPolyVoltage (c);
-        frequency += (TBase::inputs[FREQ_CV_INPUT].getPolyVoltage (c) * freqAttenuverterParam);
+        float_4 frequency = freqParam;
+        frequency += TBase::inputs[VOCT_INPUT].template getPolyVoltageSimd<float_4> (c);
+        frequency += TBase::inputs[FREQ_CV_INPUT].template getPolyVoltageSimd<float_4> (c) * freqAttenuverterParam;
         frequency = dsp::FREQ_C4 * simd::pow (2.0f, frequency);
-        frequency = clamp (frequency, 0.1f, maxFreq);
+        frequency = simd::clamp (frequency, float_4 (0.1f), float_4 (maxFreq));
 
-        auto feedback = feedbackParam + feedbackAttenuverterParam * (TBase::inputs[FEEDBACK_CV_INPUT].getPolyVoltage (c) / 5.0f);
-        feedback = clamp (feedback, -0.9f, 0.9f);
+        float_4 feedback = feedbackParam + feedbackAttenuverterParam * (TBase::inputs[FEEDBACK_CV_INPUT].template getPolyVoltageSimd<float_4> (c) / 5.0f);
+        feedback = simd::clamp (feedback, float_4 (-0.9f), float_4 (0.9f));
 
-        auto comb = combParam + combAttenuverterParam * (TBase::inputs[COMB_CV_INPUT].getPolyVoltage (c) / 5.0f);
-        comb = clamp (comb, -1.0f, 1.0f);
+        float_4 comb = combParam + combAttenuverterParam * (TBase::inputs[COMB_CV_INPUT].template getPolyVoltageSimd<float_4> (c) / 5.0f);
+        comb = simd::clamp (comb, float_4 (-1.0f), float_4 (1.0f));
 
-        auto delayTime = 1.0f / frequency;
-        auto index = delayTime * sampleRate;
+        float_4 out = 0.0f;
+        if (combs > 1)
+        {
+            for (auto v = 0; v < 4 && c + v < channels; ++v)
+            {
+                float_4 voice = processBank (c + v, in[v], frequency[v], feedback[v], comb[v], combs);
+                out[v] = (voice[0] + voice[1] + voice[2] + voice[3]) / combs;
+            }
+        }
+        else
+        {
+            float_4 index = sampleRate / frequency;
 
-        in += buffers[c].readBuffer (index) * comb * feedback;
+            // the feedback and the feed forward share one tap
+            float_4 tap = (cubic ? buffers[g].readBufferCubic (index) : buffers[g].readBuffer (index)) * comb;
+            in += tap * feedback;
 
-        auto out = in + buffers[c].readBuffer (index) * comb;
-        buffers[c].writeBuffer (in);
+            out = in + tap;
+            buffers[g].writeBuffer (in);
+        }
 
-        dcOutFilters[c].process (out);
-        out = dcOutFilters[c].highpass();
+        out = dcOutFilters[g].process (out);
 
-        out = limiters[c].process (out);
+        out = limiters[g].process (out);
 
-        TBase::outputs[MAIN_OUTPUT].setVoltage (out * 5.0f, c);
+        TBase::outputs[MAIN_OUTPUT].setVoltageSimd (out * 5.0f, c);
     }
     TBase::outputs[MAIN_OUTPUT].setChannels (channels);
+    // only used by the modulated delay
+    TBase::outputs[QUADRATURE_OUTPUT].setVoltage (0.0f, 0);
+    TBase::outputs[QUADRATURE_OUTPUT].setChannels (1);
+}
+
+/// chorus and flanger, the delay follows the frequency controls, smoothed, swept by a sine lfo.
+/// QUADRATURE_OUTPUT reads a second tap with the lfo a quarter cycle on, for stereo.
+template <class TBase>
+inline void CombFilterComp<TBase>::stepModulatedDelay (int channels)
+{
+    auto freqParam = TBase::params[FREQUENCY_PARAM].getValue();
+    auto freqAttenuverterParam = TBase::params[FREQUENCY_CV_ATTENUVERTER_PARAM].getValue();
+    auto combParam = TBase::params[COMB_PARAM].getValue();
+    auto combAttenuverterParam = TBase::params[COMB_CV_ATTENUVERTER_PARAM].getValue();
+    auto feedbackParam = TBase::params[FEEDBACK_PARAM].getValue();
+    auto feedbackAttenuverterParam = TBase::params[FEEDBACK_CV_ATTENUVERTER_PARAM].getValue();
+    auto lfoIncrement = TBase::params[LFO_RATE_PARAM].getValue() * samplePeriod;
+    // half the delay either side at full depth
+    auto depth = TBase::params[LFO_DEPTH_PARAM].getValue() * 0.5f;
+    auto quadrature = TBase::outputs[QUADRATURE_OUTPUT].isConnected();
+    const float_4 minDelay = 2.0f;
+    const float_4 maxDelay = static_cast<float> (buffers[0].size() - 4);
+    const auto cubic = quality != sspo::PluginQuality::Level::ECO;
+
+    // each voice sweeps an equal part of a cycle on from the last, so a chord doesn't move in lockstep
+    if (channels != lfoChannels)
+    {
+        for (auto c = 0; c < channels; ++c)
+            lfoPhases[c / 4][c % 4] = static_cast<float> (c) / channels;
+        lfoChannels = channels;
+    }
+
+    for (auto c = 0; c < channels; c += 4)
+    {
+        auto g = c / 4;
+        float_4 in = TBase::inputs[MAIN_INPUT].template getPolyVoltageSimd<float_4> (c) / 5.0f;
+
+        float_4 frequency = freqParam;
+        frequency += TBase::inputs[VOCT_INPUT].template getPolyVoltageSimd<float_4> (c);
+        frequency += TBase::inputs[FREQ_CV_INPUT].template getPolyVoltageSimd<float_4> (c) * freqAttenuverterParam;
+        frequency = dsp::FREQ_C4 * simd::pow (2.0f, frequency);
+        frequency = simd::clamp (frequency, float_4 (0.1f), float_4 (maxFreq));
+
+        float_4 feedback = feedbackParam + feedbackAttenuverterParam * (TBase::inputs[FEEDBACK_CV_INPUT].template getPolyVoltageSimd<float_4> (c) / 5.0f);
+        feedback = simd::clamp (feedback, float_4 (-0.9f), float_4 (0.9f));
+
+        float_4 comb = combParam + combAttenuverterParam * (TBase::inputs[COMB_CV_INPUT].template getPolyVoltageSimd<float_4> (c) / 5.0f);
+        comb = simd::clamp (comb, float_4 (-1.0f), float_4 (1.0f));
+
+        // smoothing the delay time stops v/oct steps and fast cv zippering
+        float_4 target = simd::clamp (sampleRate / frequency, minDelay, maxDelay);
+        // starts on the target rather than sweeping up from nothing
+        smoothedDelays[g] = simd::ifelse (smoothedDelays[g] == 0.0f, target, smoothedDelays[g]);
+        smoothedDelays[g] += (target - smoothedDelays[g]) * delaySmoothing;
+
+        lfoPhases[g] += lfoIncrement;
+        lfoPhases[g] -= simd::floor (lfoPhases[g]);
+        float_4 angle = 2.0f * static_cast<float> (M_PI) * lfoPhases[g];
+
+        float_4 delay = simd::clamp (smoothedDelays[g] * (1.0f + depth * simd::sin (angle)), minDelay, maxDelay);
+        float_4 tap = (cubic ? buffers[g].readBufferCubic (delay) : buffers[g].readBuffer (delay)) * comb;
+        in += tap * feedback;
+        buffers[g].writeBuffer (in);
+
+        float_4 out = dcOutFilters[g].process (in + tap);
+        out = limiters[g].process (out);
+        TBase::outputs[MAIN_OUTPUT].setVoltageSimd (out * 5.0f, c);
+
+        if (quadrature)
+        {
+            float_4 quadratureDelay = simd::clamp (smoothedDelays[g] * (1.0f + depth * simd::cos (angle)), minDelay, maxDelay);
+            float_4 quadratureTap = cubic ? buffers[g].readBufferCubic (quadratureDelay) : buffers[g].readBuffer (quadratureDelay);
+            float_4 quadratureOut = in + quadratureTap * comb;
+            quadratureOut = quadratureDcOutFilters[g].process (quadratureOut);
+            quadratureOut = quadratureLimiters[g].process (quadratureOut);
+            TBase::outputs[QUADRATURE_OUTPUT].setVoltageSimd (quadratureOut * 5.0f, c);
+        }
+    }
+    TBase::outputs[MAIN_OUTPUT].setChannels (channels);
+    TBase::outputs[QUADRATURE_OUTPUT].setChannels (channels);
+}
+
+/// the combs of one voice share its input, four combs per float_4, returns the lanes to be summed
+template <class TBase>
+inline float_4 CombFilterComp<TBase>::processBank (int channel, float in, float frequency, float feedback, float comb, int combs)
+{
+    float_4 sum = 0.0f;
+    for (auto b = 0; b < bankGroups && b * 4 < combs; ++b)
+    {
+        float_4 combFrequency = simd::clamp (frequency * bankRatios[b], float_4 (0.1f), float_4 (maxFreq));
+        float_4 index = sampleRate / combFrequency;
+        auto& buffer = bankBuffers[channel][b];
+
+        float_4 tap = buffer.readBuffer (index) * comb;
+        float_4 x = in + tap * feedback * bankFeedbacks[b];
+        buffer.writeBuffer (x);
+
+        float_4 used = float_4 (b * 4.0f) + float_4 (0.0f, 1.0f, 2.0f, 3.0f) < float_4 (static_cast<float> (combs));
+        sum += simd::ifelse (used, x + tap, 0.0f);
+    }
+    return sum;
 }
 
 template <class TBase>
@@ -226,6 +502,24 @@ IComposite::Config CombFilterDescription<TBase>::getParam (int i)
         case CombFilterComp<TBase>::FEEDBACK_PARAM:
             ret = { 0.0f, 1.1f, 0.f, "Feedback", " ", 0, 1, 0.0f };
             break;
+        case CombFilterComp<TBase>::BANK_COMBS_PARAM:
+            ret = { 1.0f, 8.0f, 1.0f, "Bank combs", " ", 0, 1, 0.0f };
+            break;
+        case CombFilterComp<TBase>::BANK_TUNING_PARAM:
+            ret = { 0.0f, 3.0f, 0.0f, "Bank tuning", " ", 0, 1, 0.0f };
+            break;
+        case CombFilterComp<TBase>::MODE_PARAM:
+            ret = { 0.0f, 1.0f, 0.0f, "Mode", " ", 0, 1, 0.0f };
+            break;
+        case CombFilterComp<TBase>::LFO_RATE_PARAM:
+            ret = { 0.02f, 10.0f, 0.5f, "Modulation rate", " Hz", 0, 1, 0.0f };
+            break;
+        case CombFilterComp<TBase>::LFO_DEPTH_PARAM:
+            ret = { 0.0f, 1.0f, 0.3f, "Modulation depth", "%", 0, 100, 0.0f };
+            break;
+        case CombFilterComp<TBase>::QUALITY_OVERRIDE_PARAM:
+            ret = sspo::PluginQuality::overrideConfig();
+            break;
         default:
             assert (false);
     }
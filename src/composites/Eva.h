@@ -23,6 +23,9 @@
 
 #include "IComposite.h"
 #include "HardLimiter.h"
+#include "SilenceDetector.h"
+#include <array>
+#include <cstdint>
 #include <memory>
 #include <assert.h>
 
@@ -78,6 +81,15 @@ public:
     enum ParamIds
     {
         ATTENUVERTER_PARAM,
+        GAIN_MODE_PARAM,
+        ONE_GAIN_PARAM,
+        TWO_GAIN_PARAM,
+        THREE_GAIN_PARAM,
+        FOUR_GAIN_PARAM,
+        FIVE_GAIN_PARAM,
+        SIX_GAIN_PARAM,
+        SEVEN_GAIN_PARAM,
+        EIGHT_GAIN_PARAM,
         NUM_PARAMS
     };
     enum InputIds
@@ -105,6 +117,11 @@ public:
 
     constexpr static int inputCount = 8;
 
+    void setSampleRate (float rate)
+    {
+        silence.setSampleRate (rate);
+    }
+
     int maxInputChannels()
     {
         auto ret = 0;
@@ -116,36 +133,135 @@ public:
         return ret;
     }
 
+    /// with the gain mode on each input has its own level, as an 8 x 1 polyphonic mixer
+    bool isGainMode()
+    {
+        return TBase::params[GAIN_MODE_PARAM].getValue() > 0.5f;
+    }
+
+    /// the mix has no state, so it stops on the first silent hold time
+    SilenceDetector silence;
+
     void step() override;
+
+private:
+    /// bit i is set while input i has a cable, monoInputs are the ones with a single channel
+    uint32_t connectedInputs = 0;
+    uint32_t monoInputs = 0;
+    std::array<int, inputCount> inputChannels{};
+    int outputChannels = 0;
+
+    /// the connected inputs, split into mono and poly, rebuilt when a cable changes
+    std::array<int, inputCount> monoIds{};
+    int monoCount = 0;
+    std::array<int, inputCount> polyIds{};
+    int polyCount = 0;
+
+    void updateConnections();
+    float inputPeak();
 };
 
+template <class TBase>
+inline void EvaComp<TBase>::updateConnections()
+{
+    auto changed = false;
+    for (auto i = 0; i < inputCount; ++i)
+    {
+        const auto channels = TBase::inputs[i].getChannels();
+        changed |= channels != inputChannels[i];
+        inputChannels[i] = channels;
+    }
+    if (! changed)
+        return;
+
+    connectedInputs = 0;
+    monoInputs = 0;
+    monoCount = 0;
+    polyCount = 0;
+    outputChannels = 0;
+    for (auto i = 0; i < inputCount; ++i)
+    {
+        if (inputChannels[i] == 0)
+            continue;
+        connectedInputs |= 1u << i;
+        if (inputChannels[i] == 1)
+        {
+            monoInputs |= 1u << i;
+            monoIds[monoCount++] = i;
+        }
+        else
+        {
+            polyIds[polyCount++] = i;
+        }
+        outputChannels = std::max (outputChannels, inputChannels[i]);
+    }
+}
+
+template <class TBase>
+inline float EvaComp<TBase>::inputPeak()
+{
+    // as in the mix, input channels past the cable's count are 0V so whole groups are read
+    float_4 peak = 0.0f;
+    for (auto i = 0; i < monoCount; ++i)
+        peak = simd::fmax (peak, simd::abs (float_4 (TBase::inputs[monoIds[i]].getVoltage (0))));
+    for (auto i = 0; i < polyCount; ++i)
+    {
+        for (auto c = 0; c < inputChannels[polyIds[i]]; c += 4)
+            peak = simd::fmax (peak, simd::abs (TBase::inputs[polyIds[i]].template getVoltageSimd<float_4> (c)));
+    }
+    return std::max (std::max (peak[0], peak[1]), std::max (peak[2], peak[3]));
+}
+
 template <class TBase>
 inline void EvaComp<TBase>::step()
 {
-    auto channels = maxInputChannels();
-    auto attenuationParam = TBase::params[ATTENUVERTER_PARAM].getValue();
+    updateConnections();
 
-    for (auto c = 0; c < channels; c += 4)
+    if (silence.isIdle() && ! silence.wake (inputPeak()))
+    {
+        SilenceDetector::writeSilence (TBase::outputs[MAIN_OUTPUT], outputChannels);
+        return;
+    }
+
+    std::array<float, inputCount> gains;
+    gains.fill (1.0f);
+    if (isGainMode())
     {
-        float_4 out{};
         for (auto i = 0; i < inputCount; ++i)
-            out += TBase::inputs[i].template getPolyVoltageSimd<float_4> (c);
-
-        auto attenuation =
-            (TBase::inputs[ATTENUATION_CV].template getPolyVoltageSimd<float_4> (c) / 5.0f);
-        for (auto j = 0; j < 4; ++j)
-            attenuation[j] += attenuationParam;
-        float_4 attMin{ -1.0f, -1.0f, -1.0f, -1.0f };
-        float_4 attMax{ 1.0f, 1.0f, 1.0f, 1.0f };
-        attenuation = simd::clamp (attenuation, attMin, attMax);
-        out *= attenuation;
-        out = sspo::voltageSaturate (out);
+            gains[i] = TBase::params[ONE_GAIN_PARAM + i].getValue();
+    }
+
+    // a mono cable is the same in every channel, so those are summed once
+    auto monoSum = 0.0f;
+    for (auto i = 0; i < monoCount; ++i)
+        monoSum += TBase::inputs[monoIds[i]].getVoltage (0) * gains[monoIds[i]];
+
+    const auto attenuationParam = TBase::params[ATTENUVERTER_PARAM].getValue();
+
+    // the mix before the attenuverter, turning it down to nothing shouldn't stop the module
+    float_4 mixPeak = 0.0f;
+    for (auto c = 0; c < outputChannels; c += 4)
+    {
+        float_4 out = monoSum;
+        for (auto i = 0; i < polyCount; ++i)
+            out += TBase::inputs[polyIds[i]].template getVoltageSimd<float_4> (c) * gains[polyIds[i]];
+        mixPeak = simd::fmax (mixPeak, simd::abs (out));
+
+        float_4 attenuation = TBase::inputs[ATTENUATION_CV].template getPolyVoltageSimd<float_4> (c) * 0.2f + attenuationParam;
+        attenuation = simd::clamp (attenuation, float_4 (-1.0f), float_4 (1.0f));
+        out = sspo::voltageSaturate (out * attenuation);
 
         //set output
         out.store (TBase::outputs[MAIN_OUTPUT].getVoltages (c));
     }
 
-    TBase::outputs[MAIN_OUTPUT].setChannels (channels);
+    // with nothing connected Rack keeps a single channel, which would hold the last voltage
+    if (outputChannels == 0)
+        TBase::outputs[MAIN_OUTPUT].setVoltage (0.0f, 0);
+    TBase::outputs[MAIN_OUTPUT].setChannels (outputChannels);
+
+    const auto peak = std::max (std::max (mixPeak[0], mixPeak[1]), std::max (mixPeak[2], mixPeak[3]));
+    silence.process (peak, peak);
 }
 
 template <class TBase>
@@ -163,6 +279,23 @@ IComposite::Config EvaDescription<TBase>::getParam (int i)
         case EvaComp<TBase>::ATTENUVERTER_PARAM:
             ret = { -1.0f, 1.0f, 1.0f, "Attenuverter", " ", 0, 1, 0.0f };
             break;
+        case EvaComp<TBase>::GAIN_MODE_PARAM:
+            ret = { 0.0f, 1.0f, 0.0f, "Input gains", " ", 0, 1, 0.0f };
+            break;
+        case EvaComp<TBase>::ONE_GAIN_PARAM:
+        case EvaComp<TBase>::TWO_GAIN_PARAM:
+        case EvaComp<TBase>::THREE_GAIN_PARAM:
+        case EvaComp<TBase>::FOUR_GAIN_PARAM:
+        case EvaComp<TBase>::FIVE_GAIN_PARAM:
+        case EvaComp<TBase>::SIX_GAIN_PARAM:
+        case EvaComp<TBase>::SEVEN_GAIN_PARAM:
+        case EvaComp<TBase>::EIGHT_GAIN_PARAM:
+        {
+            static const char* names[] = { "Input 1 gain", "Input 2 gain", "Input 3 gain", "Input 4 gain",
+                                           "Input 5 gain", "Input 6 gain", "Input 7 gain", "Input 8 gain" };
+            ret = { 0.0f, 1.0f, 1.0f, names[i - EvaComp<TBase>::ONE_GAIN_PARAM], "%", 0, 100, 0.0f };
+            break;
+        }
         default:
             assert (false);
     }
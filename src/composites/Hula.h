@@ -22,9 +22,13 @@
 #pragma once
 
 #include "IComposite.h"
+#include "PluginQuality.h"
 #include "LookupTable.h"
 #include "AudioMath.h"
 #include "dsp/UtilityFilters.h"
+#include "dsp/HulaEngine.h"
+#include <array>
+#include <memory>
 
 namespace rack
 {
@@ -90,6 +94,16 @@ public:
         OCTAVE_PARAM,
         DEPTH_PARAM,
         FEEDBACK_PARAM,
+        QUALITY_PARAM,
+        OPERATORS_PARAM,
+        ALGORITHM_PARAM,
+        OP2_RATIO_PARAM,
+        OP2_LEVEL_PARAM,
+        OP3_RATIO_PARAM,
+        OP3_LEVEL_PARAM,
+        OP4_RATIO_PARAM,
+        OP4_LEVEL_PARAM,
+        QUALITY_OVERRIDE_PARAM,
         NUM_PARAMS
     };
     enum InputIds
@@ -110,108 +124,106 @@ public:
         NUM_LIGHTS
     };
 
-    constexpr static int SIMD_CHANNELS = 4;
-    float reciprocalSampleRate = 1;
-    float sampleRate = 1;
-    std::array<float_4, SIMD_CHANNELS> lastOuts;
-    std::array<float_4, SIMD_CHANNELS> phases;
-    std::array<float_4, SIMD_CHANNELS> fineTuneVocts;
+    using Quality = sspo::HulaEngine::Quality;
+    /// the QUALITY_PARAM value that takes the oversampling from the plugin quality
+    static constexpr int followQuality = static_cast<int> (Quality::COUNT);
+    using Operators = sspo::HulaEngine::Operators;
+    using Algorithm = sspo::HulaEngine::Algorithm;
 
-    static constexpr int oversampleCount = 4;
-    static constexpr int oversampleQuality = 1;
+    static int algorithmCount (Operators operators)
+    {
+        return sspo::HulaEngine::algorithmCount (operators);
+    }
 
-    std::array<sspo::Decimator<oversampleCount, oversampleQuality, float_4>, SIMD_CHANNELS> decimators;
-    std::array<std::array<float_4, oversampleCount>, SIMD_CHANNELS> oversampleBuffers;
-    std::array<sspo::BiQuad<float_4>, SIMD_CHANNELS> dcOutFilters;
-    std::array<sspo::BiQuad<float_4>, SIMD_CHANNELS> lpFilters;
+    static const Algorithm& getAlgorithm (Operators operators, int index)
+    {
+        return sspo::HulaEngine::getAlgorithm (operators, index);
+    }
 
-    std::array<sspo::BiQuad<float_4>, SIMD_CHANNELS> depthFilters;
-    std::array<sspo::BiQuad<float_4>, SIMD_CHANNELS> feedbackFilters;
+    sspo::HulaEngine engine;
 
-    static constexpr float dcOutCutoff = 5.5f;
+    void setResampler (const sspo::Resampler newResampler)
+    {
+        engine.setResampler (newResampler);
+    }
 
     void step() override;
+
+private:
+    /// the params and connections, read once per step rather than per group
+    void readSettings();
 };
 
 template <class TBase>
 void HulaComp<TBase>::setSampleRate (float rate)
 {
-    reciprocalSampleRate = 1 / rate;
-    sampleRate = rate;
-
-    for (auto& l : lpFilters)
-        l.setButterworthLp2 (rate, std::min (10e3f, rate * 0.25f));
-
-    for (auto& dc : dcOutFilters)
-        dc.setButterworthHp2 (sampleRate, dcOutCutoff);
-
-    /// filter the changes in depth and feedback by fs/40
-    for (auto& d : depthFilters)
-        d.setButterworthLp2 (1000.0f, 25.0f);
-
-    for (auto& f : feedbackFilters)
-        f.setButterworthLp2 (1000.0f, 25.0f);
+    engine.setSampleRate (rate);
 }
 
 template <class TBase>
 void HulaComp<TBase>::init()
 {
-    // set random detune, += 5 cent;
-    for (auto& f : fineTuneVocts)
-        f = float_4 ((rand01() * 2.0f - 1.0f) * 5.0f / (12.0f * 100.0f),
-                     (rand01() * 2.0f - 1.0f) * 5.0f / (12.0f * 100.0f),
-                     (rand01() * 2.0f - 1.0f) * 5.0f / (12.0f * 100.0f),
-                     (rand01() * 2.0f - 1.0f) * 5.0f / (12.0f * 100.0f));
-
-    for (auto& l : lastOuts)
-        l = float_4 (0);
-
-    for (auto& p : phases)
-        p = float_4 (0);
+    engine.init();
+}
+
+template <class TBase>
+inline void HulaComp<TBase>::readSettings()
+{
+    sspo::HulaEngine::Settings settings;
+    settings.pitch = std::floor (TBase::params[OCTAVE_PARAM].getValue())
+                     + std::floor (TBase::params[SEMITONE_PARAM].getValue()) * (1.0f / 12.0f);
+    settings.depth = TBase::params[DEPTH_PARAM].getValue();
+    settings.feedback = TBase::params[FEEDBACK_PARAM].getValue();
+    const auto oversampling = static_cast<int> (TBase::params[QUALITY_PARAM].getValue());
+    if (oversampling >= followQuality)
+    {
+        const auto level = sspo::PluginQuality::resolve (TBase::params[QUALITY_OVERRIDE_PARAM].getValue());
+        settings.quality = sspo::PluginQuality::select (level, Quality::X2, Quality::X4, Quality::X8);
+    }
+    else
+        settings.quality = static_cast<Quality> (std::max (oversampling, 0));
+    settings.operators = static_cast<Operators> (clamp (static_cast<int> (TBase::params[OPERATORS_PARAM].getValue()),
+                                                        0,
+                                                        static_cast<int> (Operators::COUNT) - 1));
+    settings.algorithm = static_cast<int> (TBase::params[ALGORITHM_PARAM].getValue());
+
+    // operator 1 is the panel ratio at full level
+    const int ratioParams[] = { RATIO_PARAM, OP2_RATIO_PARAM, OP3_RATIO_PARAM, OP4_RATIO_PARAM };
+    const int levelParams[] = { -1, OP2_LEVEL_PARAM, OP3_LEVEL_PARAM, OP4_LEVEL_PARAM };
+    for (auto op = 0; op < sspo::HulaEngine::maxOperators; ++op)
+    {
+        settings.ratios[op] = TBase::params[ratioParams[op]].getValue();
+        settings.levels[op] = op == 0 ? 1.0f : TBase::params[levelParams[op]].getValue();
+    }
+
+    settings.depthCvConnected = TBase::inputs[DEPTH_CV_INPUT].isConnected();
+    settings.feedbackCvConnected = TBase::inputs[FEEDBACK_CV_INPUT].isConnected();
+    engine.setSettings (settings);
 }
 
 template <class TBase>
 inline void HulaComp<TBase>::step()
 {
     auto channels = std::max (1, TBase::inputs[VOCT_INPUT].getChannels());
+    readSettings();
 
-    for (auto c = 0; c < channels; c += 4)
-    {
-        //calculate frequency
-        float_4 voct = TBase::inputs[VOCT_INPUT].template getPolyVoltageSimd<float_4> (c) + fineTuneVocts[c / 4];
-        voct += simd::floor (TBase::params[OCTAVE_PARAM].getValue());
-        voct += simd::floor (TBase::params[SEMITONE_PARAM].getValue()) * (1.0f / 12.0f);
-        float_4 freq = dsp::FREQ_C4 * lookup.pow2 (voct);
-        freq *= TBase::params[RATIO_PARAM].getValue();
-        float_4 phaseInc = freq * reciprocalSampleRate / oversampleCount;
-
-        //phase offset as fm is implemented as phase modulation
-        float_4 phaseOffset = TBase::params[FEEDBACK_PARAM].getValue() * 0.053f * (lastOuts[c / 4]);
-        if (TBase::inputs[FEEDBACK_CV_INPUT].isConnected())
-        {
-            phaseOffset *= feedbackFilters[c / 4].process (simd::abs (TBase::inputs[FEEDBACK_CV_INPUT].template getPolyVoltageSimd<float_4> (c) * 0.1f));
-        }
-        float_4 fmIn = TBase::inputs[FM_INPUT].template getPolyVoltageSimd<float_4> (c) * 0.2f; // scale from +-5 to +=1
-
-        if (TBase::inputs[DEPTH_CV_INPUT].isConnected())
-        {
-            fmIn *= depthFilters[c / 4].process (simd::abs (TBase::inputs[DEPTH_CV_INPUT].template getPolyVoltageSimd<float_4> (c) * 0.1f));
-        }
-
-        phaseOffset += TBase::params[DEPTH_PARAM].getValue() * fmIn;
-
-        for (auto i = 0; i < oversampleCount; ++i)
-        {
-            //generate oversampled signal
-            phases[c / 4] += phaseInc;
-            phases[c / 4] = simd::ifelse (phases[c / 4] > float_4 (1.0f), phases[c / 4] - 1.0f, phases[c / 4]);
-            oversampleBuffers[c / 4][i] = lookup.hulaSin4 ((phases[c / 4] + phaseOffset) * k_2pi);
-        }
-
-        lastOuts[c / 4] = dcOutFilters[c / 4].process (decimators[c / 4].process (oversampleBuffers[c / 4].data())) * 5.0f;
-        TBase::outputs[MAIN_OUTPUT].setVoltageSimd (lpFilters[c / 4].process (lastOuts[c / 4]), c);
+    const auto groups = (channels + 3) / 4;
+    sspo::HulaEngine::Inputs in[sspo::HulaEngine::maxGroups];
+    float_4 out[sspo::HulaEngine::maxGroups];
+    for (auto group = 0; group < groups; ++group)
+    {
+        const auto c = group * 4;
+        in[group].voct = TBase::inputs[VOCT_INPUT].template getPolyVoltageSimd<float_4> (c);
+        in[group].fm = TBase::inputs[FM_INPUT].template getPolyVoltageSimd<float_4> (c);
+        in[group].depthCv = TBase::inputs[DEPTH_CV_INPUT].template getPolyVoltageSimd<float_4> (c);
+        in[group].feedbackCv = TBase::inputs[FEEDBACK_CV_INPUT].template getPolyVoltageSimd<float_4> (c);
     }
 
+    engine.process (in, out, groups);
+
+    for (auto group = 0; group < groups; ++group)
+        TBase::outputs[MAIN_OUTPUT].setVoltageSimd (out[group], group * 4);
+
     TBase::outputs[MAIN_OUTPUT].setChannels (channels);
 }
 
@@ -243,6 +255,36 @@ IComposite::Config HulaDescription<TBase>::getParam (int i)
         case HulaComp<TBase>::FEEDBACK_PARAM:
             ret = { 0.0f, 1.0f, 0.0f, "Feedback", " ", 0, 1, 0.0f };
             break;
+        case HulaComp<TBase>::QUALITY_PARAM:
+            ret = { 0.0f, 4.0f, 4.0f, "Oversampling", " ", 0, 1, 0.0f };
+            break;
+        case HulaComp<TBase>::OPERATORS_PARAM:
+            ret = { 0.0f, 2.0f, 0.0f, "Operators", " ", 0, 1, 0.0f };
+            break;
+        case HulaComp<TBase>::ALGORITHM_PARAM:
+            ret = { 0.0f, 3.0f, 0.0f, "Algorithm", " ", 0, 1, 0.0f };
+            break;
+        case HulaComp<TBase>::OP2_RATIO_PARAM:
+            ret = { 0.5f, 25.95f, 2.0f, "Operator 2 ratio", " ", 0, 1, 0.0f };
+            break;
+        case HulaComp<TBase>::OP2_LEVEL_PARAM:
+            ret = { 0.0f, 1.0f, 0.5f, "Operator 2 level", " ", 0, 1, 0.0f };
+            break;
+        case HulaComp<TBase>::OP3_RATIO_PARAM:
+            ret = { 0.5f, 25.95f, 3.0f, "Operator 3 ratio", " ", 0, 1, 0.0f };
+            break;
+        case HulaComp<TBase>::OP3_LEVEL_PARAM:
+            ret = { 0.0f, 1.0f, 0.5f, "Operator 3 level", " ", 0, 1, 0.0f };
+            break;
+        case HulaComp<TBase>::OP4_RATIO_PARAM:
+            ret = { 0.5f, 25.95f, 4.0f, "Operator 4 ratio", " ", 0, 1, 0.0f };
+            break;
+        case HulaComp<TBase>::OP4_LEVEL_PARAM:
+            ret = { 0.0f, 1.0f, 0.5f, "Operator 4 level", " ", 0, 1, 0.0f };
+            break;
+        case HulaComp<TBase>::QUALITY_OVERRIDE_PARAM:
+            ret = sspo::PluginQuality::overrideConfig();
+            break;
 
         default:
             assert (false);
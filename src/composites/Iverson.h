@@ -24,6 +24,7 @@
 #include <memory>
 #include <bitset>
 #include "IComposite.h"
+#include "PluginQuality.h"
 #include "TriggerSequencer.h"
 #include "digital.hpp"
 
@@ -249,6 +250,7 @@ namespace sspo
             SET_EUCLIDEAN_HITS_PARAM,
             ROTATE_TRACK_PARAM,
             USE_ROTARY_ENCODERS_PARAM,
+            QUALITY_OVERRIDE_PARAM,
             NUM_PARAMS
         };
         enum InputIds
@@ -314,6 +316,13 @@ namespace sspo
         bool isRotateTrack = false;
         bool clock = false;
         dsp::ClockDivider ledDivider;
+        /// samples between reads of the grid buttons at Normal quality, the quality scales it
+        static constexpr int ledDivision = 512;
+
+        PluginQuality::Level getQuality()
+        {
+            return PluginQuality::resolve (TBase::params[QUALITY_OVERRIDE_PARAM].getValue());
+        }
 
         struct Triggers
         {
@@ -364,7 +373,7 @@ namespace sspo
             tracks.resize (TRACK_COUNT);
             for (auto& t : tracks)
                 t.setActive (true);
-            ledDivider.setDivision (512);
+            ledDivider.setDivision (PluginQuality::scaleDivision (ledDivision, getQuality()));
         }
 
         void step() override;
@@ -405,6 +414,7 @@ namespace sspo
             lengthInput();
             euclideanHitsInput();
             rotateTrackInput();
+            ledDivider.setDivision (PluginQuality::scaleDivision (ledDivision, getQuality()));
         }
 
         pageChangeInputs();
@@ -721,6 +731,9 @@ namespace sspo
             case IversonComp<TBase>::USE_ROTARY_ENCODERS_PARAM:
                 ret = { 0.0f, 1.0f, 0.0f, "use rotary encoders", " ", 0, 1, 0.0f };
                 break;
+            case IversonComp<TBase>::QUALITY_OVERRIDE_PARAM:
+                ret = PluginQuality::overrideConfig();
+                break;
 
             default:
                 if (i <= IversonComp<TBase>::PRIMARY_PROB_8)
@@ -22,10 +22,14 @@
 #pragma once
 
 #include "IComposite.h"
+#include "PluginQuality.h"
 #include "LookupTable.h"
 #include "CircularBuffer.h"
+#include "UtilityFilters.h"
 #include "HardLimiter.h"
+#include "Exciter.h"
 
+#include <array>
 #include <cstdlib>
 #include <vector>
 
@@ -83,36 +87,41 @@ public:
         maxCutoff = std::min (rate / 2.0f, 20000.0f);
 
         for (auto& dc : dcInFilters)
-            dc.setParameters (rack::dsp::BiquadFilter::HIGHPASS, dcInFilterCutoff / rate, 0.141f, 1.0f);
+            dc.setCutoff (rate, dcInFilterCutoff);
+
+        for (auto& dc : dcOutFilters)
+            dc.setCutoff (rate, dcOutFilterCutoff);
 
         for (auto& l : limiters)
             l.setSampleRate (rate);
+
+        exciters.setSampleRate (rate);
     }
 
     // must be called after setSampleRate
     void init()
     {
-        buffers.resize (maxChannels);
+        buffers.resize (maxGroups);
         for (auto& b : buffers)
             b.reset (4096);
 
-        dcInFilters.resize (maxChannels);
+        dcInFilters.resize (maxGroups);
         for (auto& dc : dcInFilters)
-            dc.setParameters (rack::dsp::BiquadFilter::HIGHPASS, dcInFilterCutoff / sampleRate, 0.141f, 1.0f);
+            dc.setCutoff (sampleRate, dcInFilterCutoff);
 
-        dcOutFilters.resize (maxChannels);
+        dcOutFilters.resize (maxGroups);
         for (auto& dc : dcOutFilters)
-            dc.setParameters (rack::dsp::BiquadFilter::HIGHPASS, dcOutFilterCutoff / sampleRate, 0.141f, 1.0f);
+            dc.setCutoff (sampleRate, dcOutFilterCutoff);
 
-        lastWets.resize (maxChannels);
+        lastWets.resize (maxGroups);
         for (auto& lw : lastWets)
             lw = 0;
 
-        delayTimes.resize (maxChannels);
+        delayTimes.resize (maxGroups);
         for (auto& d : delayTimes)
             d = 0;
 
-        limiters.resize (maxChannels);
+        limiters.resize (maxGroups);
         for (auto& l : limiters)
         {
             l.setTimes (0.00f, 0.0025f);
@@ -120,27 +129,26 @@ public:
             l.threshold = -0.50f;
         }
 
-        oscphases.resize (maxChannels);
-        for (auto& perChannel : oscphases)
+        oscphases.resize (maxGroups * maxOscCount);
+        for (auto& phase : oscphases)
         {
-            perChannel.resize (maxOscCount);
-            for (auto& phase : perChannel)
-            {
-                phase = static_cast<float> (std::rand()) / RAND_MAX;
-            }
+            for (auto i = 0; i < 4; ++i)
+                phase[i] = static_cast<float> (std::rand()) / RAND_MAX;
         }
 
-        glide.resize (maxChannels);
+        glide.resize (maxGroups);
         for (auto& g : glide)
             g.setRiseFall (0.01f, 0.01f);
 
-        lastOut.resize (maxChannels);
+        lastOut.resize (maxGroups);
         for (auto& lo : lastOut)
             lo = 0.000f;
 
-        pitches.resize (maxChannels);
-        for (auto& p : pitches)
-            p = dsp::FREQ_C4;
+        exciters.setGroups (maxGroups);
+
+        controls.assign (maxGroups, VoiceControls());
+        controlCounter = 0;
+        controlsPrimed = false;
 
         unisonTunings = { 0.0f, -0.01952356f, 0.01991221f, -0.06288439f, 0.06216538f, -0.11002313f, 0.10745242f };
     }
@@ -148,14 +156,30 @@ public:
     //supersaw curves from "How to emulate the supersaw, Adam Szabo"
     // 0.0f <= x <= 1
 
-    float unisonCentreLevel (const float x)
+    template <typename T>
+    T unisonCentreLevel (const T x)
     {
-        return -0.55366 * x + 0.99785;
+        return -0.55366f * x + 0.99785f;
     }
 
-    float unisonSideLevel (const float x)
+    template <typename T>
+    T unisonSideLevel (const T x)
     {
-        return -0.73764 * x * x + 1.2841 * x + 0.044372;
+        return -0.73764f * x * x + 1.2841f * x + 0.044372f;
+    }
+
+    /// how stretch picks between the plain and the averaged feedback
+    enum class StretchMode
+    {
+        RANDOM,
+        DETERMINISTIC
+    };
+
+    StretchMode stretchMode = StretchMode::RANDOM;
+
+    void setStretchMode (StretchMode m)
+    {
+        stretchMode = m;
     }
 
     // Define all the enums here. This will let the tests and the widget access them.
@@ -170,6 +194,9 @@ public:
         UNISON_MIX_PARAM,
         STRETCH_PARAM,
         STRETCH_LOCK_PARAM,
+        CONTROL_RATE_PARAM,
+        EXCITER_PARAM,
+        QUALITY_OVERRIDE_PARAM,
         NUM_PARAMS
     };
 
@@ -182,6 +209,7 @@ public:
         UNISON_SPREAD_INPUT,
         UNISON_MIX_INPUT,
         STRETCH_INPUT,
+        GATE_INPUT,
         NUM_INPUTS
     };
 
@@ -205,122 +233,264 @@ public:
     float maxCutoff = 20000.0f;
 
     constexpr static int maxChannels = 16;
+    // voices are processed in groups of four, one per float_4 lane
+    constexpr static int maxGroups = maxChannels / 4;
     constexpr static float dcInFilterCutoff = 5.5f;
     constexpr static float dcOutFilterCutoff = 10.0f;
     constexpr static int maxOscCount = 7;
+    // a voice sleeps once input and delay line stay below idleThreshold volts for a whole buffer
+    constexpr static float idleThreshold = 0.0001f;
+    constexpr static float idleSamples = 4096.0f;
 
     //Oscillator detunings for unisson from "How to emulate the super saw, Adam Szabo"
     //
     std::vector<float> unisonTunings;
     std::vector<float> unisonLevels;
-    std::vector<CircularBuffer<float>> buffers;
-    std::vector<rack::dsp::BiquadFilter> dcInFilters;
-    std::vector<rack::dsp::BiquadFilter> dcOutFilters;
-    std::vector<sspo::Compressor> limiters;
-    std::vector<float> lastWets;
-    std::vector<float> delayTimes;
-    std::vector<std::vector<float>> oscphases;
-    std::vector<dsp::SlewLimiter> glide;
-    std::vector<int> framesToSample;
-    std::vector<float> lastOut;
-    std::vector<float> pitches;
+    // all the per voice state is per group of four voices
+    std::vector<InterleavedCircularBuffer> buffers;
+    std::vector<sspo::DcBlocker<float_4>> dcInFilters;
+    std::vector<sspo::DcBlocker<float_4>> dcOutFilters;
+    std::vector<sspo::TCompressor<float_4>> limiters;
+    std::vector<float_4> lastWets;
+    std::vector<float_4> delayTimes;
+    // flat block of unison phases, [group * maxOscCount + osc], one voice per lane
+    std::vector<float_4> oscphases;
+    std::vector<dsp::TSlewLimiter<float_4>> glide;
+    std::vector<float_4> lastOut;
+
+    /// per group values evaluated at control rate, the levels ramp linearly between updates
+    struct VoiceControls
+    {
+        float_4 pitch = dsp::FREQ_C4;
+        float_4 stretch = 0.0f;
+        float_4 unison = 1.0f;
+        int maxUnison = 1;
+        float_4 spread = 0.0f;
+        float_4 spreadStep = 0.0f;
+        float_4 centreLevel = 1.0f;
+        float_4 centreStep = 0.0f;
+        float_4 sideLevel = 0.0f;
+        float_4 sideStep = 0.0f;
+        float_4 quietSamples = 0.0f;
+        /// V/Oct at the last control step
+        float_4 voct = 0.0f;
+    };
+    std::vector<VoiceControls> controls;
+    /// built in excitation, started by GATE_INPUT and added to IN_INPUT
+    sspo::ExciterBank exciters;
 
 private:
+    /// knobs and cv that don't need audio rate, run every controlDivision samples
+    void stepControls (int channels);
+
     float reciprocalSampleRate = 1.0f;
     float sampleRate = 1.0f;
+    int controlCounter = 0;
+    int controlDivision = 16;
+    int controlChannels = 0;
+    bool controlsPrimed = false;
 };
 
 template <class TBase>
 inline void KSDelayComp<TBase>::step()
 {
     auto channels = std::max (TBase::inputs[IN_INPUT].getChannels(), TBase::inputs[VOCT].getChannels());
-    auto octaveParam = TBase::params[OCTAVE_PARAM].getValue();
-    auto tuneParam = TBase::params[TUNE_PARAM].getValue();
-    auto feedbackParam = TBase::params[FEEDBACK_PARAM].getValue();
-    auto unisonCount = TBase::params[UNISON_PARAM].getValue();
-    auto unisonSpread = TBase::params[UNISON_SPREAD_PARAM].getValue();
-    auto unisonMix = TBase::params[UNISON_MIX_PARAM].getValue();
-    auto stretchParam = TBase::params[STRETCH_PARAM].getValue();
-
-    auto glideParam = 0.05f;
-
+    channels = std::max (channels, TBase::inputs[GATE_INPUT].getChannels());
     channels = std::max (channels, 1);
 
-    for (auto i = 0; i < channels; ++i)
+    // nor can a new note on a sleeping voice, it wakes on this sample at its new pitch
+    auto noteWakes = false;
+    for (auto c = 0; c < channels; c += 4)
     {
-        auto unisonSpreadCoefficient = lookup.unisonSpread (unisonSpread + std::abs (TBase::inputs[UNISON_SPREAD_INPUT].getPolyVoltage (i) / 10.0f));
-        auto unisonSideLevelCoefficient = unisonSideLevel (unisonMix + std::abs (TBase::inputs[UNISON_MIX_INPUT].getPolyVoltage (i) / 10.0f));
-        auto unisonCentreLevelCoefficient = unisonCentreLevel (unisonMix + std::abs (TBase::inputs[UNISON_MIX_INPUT].getPolyVoltage (i) / 10.0f));
+        const auto& control = controls[c / 4];
+        float_4 newNote = TBase::inputs[VOCT].template getPolyVoltageSimd<float_4> (c) != control.voct;
+        noteWakes |= simd::movemask (newNote & (control.quietSamples >= idleSamples)) != 0;
+    }
 
-        auto in = TBase::inputs[IN_INPUT].getPolyVoltage (i);
+    // new voices can't wait for the next control step
+    if (controlCounter == 0 || channels != controlChannels || noteWakes)
+    {
+        const auto level = sspo::PluginQuality::resolve (TBase::params[QUALITY_OVERRIDE_PARAM].getValue());
+        // 0 takes the division from the quality
+        const auto rateParam = static_cast<int> (TBase::params[CONTROL_RATE_PARAM].getValue());
+        controlDivision = rateParam >= 1 ? rateParam : sspo::PluginQuality::select (level, 32, 16, 4);
+        const auto limiterDivision = sspo::PluginQuality::select (level, 8, 4, 2);
+        for (auto& l : limiters)
+            l.setDivision (limiterDivision);
+        stepControls (channels);
+        controlChannels = channels;
+    }
+    if (++controlCounter >= controlDivision)
+        controlCounter = 0;
+
+    auto feedbackParam = TBase::params[FEEDBACK_PARAM].getValue();
+    auto useExciter = TBase::inputs[GATE_INPUT].isConnected() && exciters.getShape() != sspo::ExciterBank::Shape::OFF;
+    float_4 excitations[maxGroups];
+    if (useExciter)
+    {
+        float_4 gates[maxGroups];
+        for (auto c = 0; c < channels; c += 4)
+            gates[c / 4] = TBase::inputs[GATE_INPUT].template getPolyVoltageSimd<float_4> (c);
+        exciters.process (gates, excitations, (channels + 3) / 4);
+    }
 
-        in = dcInFilters[i].process (in);
-        auto feedback = feedbackParam + TBase::inputs[FEEDBACK_INPUT].getPolyVoltage (i) / 10.0f;
-        feedback = clamp (feedback, 0.0f, 0.5f);
+    for (auto c = 0; c < channels; c += 4)
+    {
+        auto g = c / 4;
+        auto& control = controls[g];
+        control.spread += control.spreadStep;
+        control.centreLevel += control.centreStep;
+        control.sideLevel += control.sideStep;
+
+        float_4 rawIn = TBase::inputs[IN_INPUT].template getPolyVoltageSimd<float_4> (c);
+        if (useExciter)
+            rawIn += excitations[g];
+
+        // a sleeping voice wakes as soon as anything arrives at its input
+        control.quietSamples = simd::ifelse (simd::abs (rawIn) < idleThreshold, control.quietSamples, 0.0f);
+        float_4 sleeping = control.quietSamples >= idleSamples;
+        if (simd::movemask (sleeping) == 0xf)
+        {
+            TBase::outputs[OUT_OUTPUT].setVoltageSimd (float_4 (0.0f), c);
+            continue;
+        }
 
-        auto glideTime = glideParam;
+        float_4 in = dcInFilters[g].process (rawIn);
+        float_4 feedback = feedbackParam + TBase::inputs[FEEDBACK_INPUT].template getPolyVoltageSimd<float_4> (c) / 10.0f;
+        feedback = simd::clamp (feedback, float_4 (0.0f), float_4 (0.5f));
 
-        glide[i].setRiseFall (glideTime, glideTime);
-        auto glideFreq = glide[i].process (10.0f, dsp::FREQ_C4 * lookup.pow2 (TBase::inputs[VOCT].getPolyVoltage (i) + octaveParam + tuneParam / 12.0f));
-        glideFreq = clamp (glideFreq, 20.0f, maxCutoff);
-        delayTimes[i] = 1.0f / glideFreq;
+        float_4 glideFreq = glide[g].process (10.0f, control.pitch);
+        glideFreq = simd::clamp (glideFreq, float_4 (20.0f), float_4 (maxCutoff));
+        delayTimes[g] = 1.0f / glideFreq;
 
-        auto index = delayTimes[i] * sampleRate - 1.5f;
+        float_4 index = delayTimes[g] * sampleRate - 1.5f;
 
         // update buffer
-        auto wet = buffers[i].readBuffer (index);
+        float_4 wet = buffers[g].readBuffer (index);
 
-        auto stretch = stretchParam;
-        if (TBase::inputs[STRETCH_INPUT].isConnected())
+        float_4 stretch = control.stretch * 0.0003f * glideFreq * glideFreq;
+
+        float_4 nonStretchProbabilty = 1.0f / stretch;
+        float_4 averaged = in + lastWets[g] * feedback + 0.5f * wet;
+        float_4 dry;
+        if (stretchMode == StretchMode::RANDOM)
         {
-            stretch += TBase::inputs[STRETCH_INPUT].getPolyVoltage (i) / 10.0;
+            float_4 random{ sspo::AudioMath::rand01(), sspo::AudioMath::rand01(), sspo::AudioMath::rand01(), sspo::AudioMath::rand01() };
+            float_4 useStretch = (1.0f - nonStretchProbabilty) > random;
+            dry = simd::ifelse (useStretch, in + wet, averaged);
+        }
+        else
+        {
+            // the expected value of the random choice, a lowpass whose decay follows stretch
+            float_4 stretchAmount = simd::clamp (1.0f - nonStretchProbabilty, float_4 (0.0f), float_4 (1.0f));
+            dry = averaged + stretchAmount * (in + wet - averaged);
+        }
+        dry = 5.0f * limiters[g].process (dry / 5.0f);
+        buffers[g].writeBuffer (dry);
+        lastWets[g] = wet;
+
+        // once the whole delay line has been quiet the voice goes to sleep
+        float_4 quiet = (simd::abs (rawIn) < idleThreshold) & (simd::abs (dry) < idleThreshold);
+        control.quietSamples = simd::ifelse (quiet, simd::fmin (control.quietSamples + 1.0f, idleSamples), 0.0f);
+        float_4 asleep = control.quietSamples >= idleSamples;
+        if (simd::movemask (asleep) & ~simd::movemask (sleeping))
+        {
+            buffers[g].clearLanes (asleep);
+            lastWets[g] = simd::ifelse (asleep, 0.0f, lastWets[g]);
         }
-        stretch = stretch * 0.0003f * glideFreq * glideFreq;
-
-        auto nonStretchProbabilty = 1.0f / stretch;
-        auto useStretch = (1.0f - nonStretchProbabilty) > sspo::AudioMath::rand01();
-
-        auto dry = useStretch
-                       ? in + wet
-                       : in + lastWets[i] * feedback + 0.5f * wet;
-        dry = 5.0f * limiters[i].process (dry / 5.0f);
-        buffers[i].writeBuffer (dry);
-        lastWets[i] = wet;
 
         // calc phases
-        auto mixedOsc = 0.0f;
-        auto unison = std::abs (std::min (static_cast<int> (unisonCount + TBase::inputs[UNISON_INPUT].getPolyVoltage (i)), 7));
-        if (unisonCount == 1)
-            unisonCentreLevelCoefficient = 1.0f;
-        for (int osc = 0; osc < unison; ++osc)
+        const float_4 unison = control.unison;
+        const auto maxUnison = control.maxUnison;
+        float_4 phaseStep = control.spread / index;
+        float_4* phases = &oscphases[g * maxOscCount];
+        std::array<float_4, maxOscCount> taps;
+        std::array<float_4, maxOscCount> levels;
+        for (int osc = 0; osc < maxUnison; ++osc)
         {
-            oscphases[i][osc] += (unisonTunings[osc] * unisonSpreadCoefficient) / index;
-            if (oscphases[i][osc] >= 1.0f)
-                oscphases[i][osc] -= 1.0f;
-            if (oscphases[i][osc] < 0.0f)
-                oscphases[i][osc] += 1.0f;
-
-            auto phaseoffset = index - oscphases[i][osc] * index;
-            if (osc == 0)
-                mixedOsc += buffers[i].readBuffer (phaseoffset) * unisonCentreLevelCoefficient;
-            else
-                mixedOsc += buffers[i].readBuffer (phaseoffset) * unisonSideLevelCoefficient;
+            // voices with fewer unison oscillators leave the rest idle
+            float_4 active = float_4 (osc) < unison;
+            float_4 phase = phases[osc] + unisonTunings[osc] * phaseStep;
+            phase -= simd::floor (phase);
+            phases[osc] = simd::ifelse (active, phase, phases[osc]);
+
+            taps[osc] = index - phases[osc] * index;
+            levels[osc] = simd::ifelse (active, osc == 0 ? control.centreLevel : control.sideLevel, 0.0f);
         }
+        float_4 mixedOsc = buffers[g].readTaps (taps.data(), levels.data(), maxUnison);
         wet = mixedOsc;
 
-        auto mix = 1.0f;
-        mix = clamp (mix, 0.0f, 1.0f);
-        float out = crossfade (in, wet, mix);
+        const float dryWetMix = 1.0f;
+        float_4 out = in + (wet - in) * dryWetMix;
 
-        out = dcOutFilters[i].process (out);
+        out = dcOutFilters[g].process (out);
         out = sspo::voltageSaturate (out);
-        lastOut[i] = out;
+        out = simd::ifelse (asleep, 0.0f, out);
+        lastOut[g] = out;
 
-        TBase::outputs[OUT_OUTPUT].setVoltage (out, i);
+        TBase::outputs[OUT_OUTPUT].setVoltageSimd (out, c);
     }
     TBase::outputs[OUT_OUTPUT].setChannels (channels);
 }
 
+template <class TBase>
+inline void KSDelayComp<TBase>::stepControls (int channels)
+{
+    auto octaveParam = TBase::params[OCTAVE_PARAM].getValue();
+    auto tuneParam = TBase::params[TUNE_PARAM].getValue();
+    auto unisonCount = TBase::params[UNISON_PARAM].getValue();
+    auto unisonSpread = TBase::params[UNISON_SPREAD_PARAM].getValue();
+    auto unisonMix = TBase::params[UNISON_MIX_PARAM].getValue();
+    auto stretchParam = TBase::params[STRETCH_PARAM].getValue();
+
+    exciters.setShape (static_cast<sspo::ExciterBank::Shape> (TBase::params[EXCITER_PARAM].getValue()));
+
+    auto glideTime = 0.05f;
+    auto rampSamples = static_cast<float> (controlDivision);
+
+    for (auto c = 0; c < channels; c += 4)
+    {
+        auto& control = controls[c / 4];
+
+        float_4 spread = unisonSpread + simd::abs (TBase::inputs[UNISON_SPREAD_INPUT].template getPolyVoltageSimd<float_4> (c) / 10.0f);
+        // keep inside the lookup table
+        float_4 spreadTarget = lookup.unisonSpread (simd::clamp (spread, float_4 (0.0f), float_4 (1.09f)));
+        float_4 mix = unisonMix + simd::abs (TBase::inputs[UNISON_MIX_INPUT].template getPolyVoltageSimd<float_4> (c) / 10.0f);
+        float_4 sideTarget = unisonSideLevel (mix);
+        float_4 centreTarget = unisonCentreLevel (mix);
+        if (unisonCount == 1)
+            centreTarget = 1.0f;
+
+        if (! controlsPrimed)
+        {
+            // start on the targets, so the first steps add nothing
+            control.spread = spreadTarget;
+            control.centreLevel = centreTarget;
+            control.sideLevel = sideTarget;
+        }
+        // the smoothed values reach their targets at the next control step
+        control.spreadStep = (spreadTarget - control.spread) / rampSamples;
+        control.centreStep = (centreTarget - control.centreLevel) / rampSamples;
+        control.sideStep = (sideTarget - control.sideLevel) / rampSamples;
+
+        glide[c / 4].setRiseFall (glideTime, glideTime);
+        control.voct = TBase::inputs[VOCT].template getPolyVoltageSimd<float_4> (c);
+        float_4 voct = control.voct + octaveParam + tuneParam / 12.0f;
+        float_4 pitch = dsp::FREQ_C4 * lookup.pow2 (voct);
+        // a new note wakes the voice
+        control.quietSamples = simd::ifelse (pitch != control.pitch, 0.0f, control.quietSamples);
+        control.pitch = pitch;
+
+        control.stretch = stretchParam;
+        if (TBase::inputs[STRETCH_INPUT].isConnected())
+            control.stretch += TBase::inputs[STRETCH_INPUT].template getPolyVoltageSimd<float_4> (c) / 10.0f;
+
+        control.unison = simd::fmin (simd::abs (simd::trunc (unisonCount + TBase::inputs[UNISON_INPUT].template getPolyVoltageSimd<float_4> (c))), float_4 (maxOscCount));
+        control.maxUnison = static_cast<int> (std::max (std::max (control.unison[0], control.unison[1]), std::max (control.unison[2], control.unison[3])));
+    }
+    controlsPrimed = true;
+}
+
 template <class TBase>
 int KSDelayDescription<TBase>::getNumParams()
 {
@@ -357,6 +527,15 @@ IComposite::Config KSDelayDescription<TBase>::getParam (int i)
         case KSDelayComp<TBase>::STRETCH_LOCK_PARAM:
             ret = { 0.0f, 1.0f, 1.0f, "Stretch Lock", " ", 0, 1, 0.0f };
             break;
+        case KSDelayComp<TBase>::CONTROL_RATE_PARAM:
+            ret = { 0.0f, 64.0f, 0.0f, "Control rate division", " samples", 0, 1, 0.0f };
+            break;
+        case KSDelayComp<TBase>::EXCITER_PARAM:
+            ret = { 0.0f, 4.0f, 0.0f, "Exciter", " ", 0, 1, 0.0f };
+            break;
+        case KSDelayComp<TBase>::QUALITY_OVERRIDE_PARAM:
+            ret = sspo::PluginQuality::overrideConfig();
+            break;
         default:
             assert (false);
     }
@@ -24,12 +24,16 @@
 #include "IComposite.h"
 #include "UtilityFilters.h"
 #include "HardLimiter.h"
+#include "SilenceDetector.h"
 
 #include "simd/functions.hpp"
 #include "simd/sse_mathfun.h"
 #include "simd/sse_mathfun_extension.h"
 //#include "simd/vector.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <memory>
 #include <vector>
 
@@ -86,6 +90,8 @@ public:
     {
         FREQ_PARAM,
         FREQ_CV_PARAM,
+        SPREAD_PARAM,
+        BANDS_PARAM,
         NUM_PARAMS
     };
     enum InputIds
@@ -98,6 +104,8 @@ public:
     {
         HIGH_OUTPUT,
         LOW_OUTPUT,
+        LOW_MID_OUTPUT,
+        HIGH_MID_OUTPUT,
         NUM_OUTPUTS
     };
     enum LightIds
@@ -107,16 +115,22 @@ public:
 
     // member variables
     static constexpr int maxChannels = 16;
-    static constexpr float dcBlockerFc = 5.5f;
-    const float_4 dc_4{ dcBlockerFc, dcBlockerFc, dcBlockerFc, dcBlockerFc };
     float sampleRate = 1.0f;
     float sampleTime = 1.0f;
     float_4 sr_4{ sampleRate, sampleRate, sampleRate, sampleRate };
     float_4 maxFreq = { 0.5f, 0.5f, 0.5f, 0.5f };
     float_4 minFreq = { 10, 10, 10, 10 };
-    // filters and dc blocker filter for each band
-    std::vector<sspo::LinkwitzRileyLP4<float_4>> lpFilters;
-    std::vector<sspo::LinkwitzRileyHP4<float_4>> hpFilters;
+    // crossover filter for each group of four channels
+    std::vector<sspo::LinkwitzRileyCrossover<float_4>> crossovers;
+    // 3 and 4 band crossover for each group of four channels
+    std::vector<sspo::LinkwitzRileyMultiband<float_4>> multibands;
+    std::vector<float_4> lastFcvs;
+    int lastBands = -1;
+    float lastSpread = -1.0f;
+    // outer split frequencies relative to the frequency param
+    float lowRatio = 1.0f;
+    float highRatio = 1.0f;
+    SilenceDetector silence;
 
     void setSampleRate (float rate)
     {
@@ -125,15 +139,36 @@ public:
         sr_4 = { sampleRate, sampleRate, sampleRate, sampleRate };
         auto m = rate / 2.0f;
         maxFreq = { m, m, m, m };
+        for (auto& l : lastFcvs)
+            l = float_4 (-100.0f);
+        silence.setSampleRate (rate);
     }
     // must be called after setSampleRate
     void init()
     {
-        hpFilters.resize (maxChannels / 4);
-        lpFilters.resize (maxChannels / 4);
+        crossovers.resize (maxChannels / 4);
+        multibands.resize (maxChannels / 4);
+        lastFcvs.resize (maxChannels / 4);
+        for (auto& l : lastFcvs)
+            l = float_4 (-100.0f);
     }
 
     inline void step() override;
+
+private:
+    inline void updateBands();
+    inline void stepTwoBands (int channels, float freqParam);
+    inline void stepMultiband (int channels, float freqParam);
+    inline float outputPeak();
+
+    /// the outputs used by each band count, from the lowest band to the highest
+    static const int* bandOutputs (int bands)
+    {
+        static constexpr int twoBandOutputs[] = { LOW_OUTPUT, HIGH_OUTPUT };
+        static constexpr int threeBandOutputs[] = { LOW_OUTPUT, LOW_MID_OUTPUT, HIGH_OUTPUT };
+        static constexpr int fourBandOutputs[] = { LOW_OUTPUT, LOW_MID_OUTPUT, HIGH_MID_OUTPUT, HIGH_OUTPUT };
+        return bands == 2 ? twoBandOutputs : (bands == 3 ? threeBandOutputs : fourBandOutputs);
+    }
 };
 
 template <class TBase>
@@ -143,20 +178,90 @@ inline void LaLaComp<TBase>::step()
     auto freqParam = TBase::params[FREQ_PARAM].getValue();
     freqParam = freqParam * 10.0f - 5.0f;
 
+    updateBands();
+
+    const auto inputPeak = SilenceDetector::peak (TBase::inputs[MAIN_INPUT]);
+    if (silence.isIdle() && ! silence.wake (inputPeak))
+    {
+        for (auto b = 0; b < lastBands; ++b)
+            SilenceDetector::writeSilence (TBase::outputs[bandOutputs (lastBands)[b]], channels);
+        return;
+    }
+
+    if (lastBands == 2)
+        stepTwoBands (channels, freqParam);
+    else
+        stepMultiband (channels, freqParam);
+    silence.process (inputPeak, outputPeak());
+}
+
+template <class TBase>
+inline float LaLaComp<TBase>::outputPeak()
+{
+    auto ret = 0.0f;
+    for (auto b = 0; b < lastBands; ++b)
+        ret = std::max (ret, SilenceDetector::peak (TBase::outputs[bandOutputs (lastBands)[b]]));
+    return ret;
+}
+
+template <class TBase>
+inline void LaLaComp<TBase>::updateBands()
+{
+    auto bands = static_cast<int> (std::round (TBase::params[BANDS_PARAM].getValue()));
+    bands = std::max (2, std::min (bands, sspo::LinkwitzRileyMultiband<float_4>::maxBands));
+    auto spread = TBase::params[SPREAD_PARAM].getValue();
+    if (bands == lastBands && spread == lastSpread)
+        return;
+
+    lastBands = bands;
+    lastSpread = spread;
+    // 4 bands split an octave spread either side of the frequency, 3 bands split half either side
+    auto octaves = bands == 4 ? spread : spread * 0.5f;
+    lowRatio = std::pow (2.0f, -octaves);
+    highRatio = std::pow (2.0f, octaves);
+    if (bands > 2)
+    {
+        for (auto& m : multibands)
+            m.setBands (bands);
+    }
+    for (auto& l : lastFcvs)
+        l = float_4 (-100.0f);
+
+    // silence the outputs not used in this mode
+    if (bands < 4)
+    {
+        TBase::outputs[HIGH_MID_OUTPUT].setChannels (1);
+        TBase::outputs[HIGH_MID_OUTPUT].setVoltage (0.0f);
+    }
+    if (bands < 3)
+    {
+        TBase::outputs[LOW_MID_OUTPUT].setChannels (1);
+        TBase::outputs[LOW_MID_OUTPUT].setVoltage (0.0f);
+    }
+}
+
+template <class TBase>
+inline void LaLaComp<TBase>::stepTwoBands (int channels, float freqParam)
+{
     for (auto c = 0; c < channels; c += 4)
     {
         auto fcv = TBase::inputs[FREQ_CV_INPUT].template getPolyVoltageSimd<float_4> (c);
         fcv *= TBase::params[FREQ_CV_PARAM].getValue();
         fcv += freqParam;
-        float_4 freq = dsp::FREQ_C4 * simd::pow (2.0f, fcv);
-        freq = simd::clamp (freq, minFreq, maxFreq);
-        lpFilters[c / 4].setParameters (sr_4, freq);
-        hpFilters[c / 4].setParameters (sr_4, freq);
+        // only recalculate the crossover when the frequency cv has changed
+        if (sspo::AudioMath::hasChanged (fcv, lastFcvs[c / 4]))
+        {
+            lastFcvs[c / 4] = fcv;
+            float_4 freq = dsp::FREQ_C4 * simd::pow (2.0f, fcv);
+            freq = simd::clamp (freq, minFreq, maxFreq);
+            crossovers[c / 4].setParameters (sr_4, freq);
+        }
         float_4 in = TBase::inputs[MAIN_INPUT].template getPolyVoltageSimd<float_4> (c);
-        auto lowOut = lpFilters[c / 4].process (in);
-        lowOut = sspo::voltageSaturate (lowOut);
-        auto highOut = hpFilters[c / 4].process (in);
+        float_4 lowOut;
+        float_4 highOut;
+        crossovers[c / 4].process (in, lowOut, highOut);
 
+        lowOut = sspo::voltageSaturate (lowOut);
         highOut = sspo::voltageSaturate (highOut);
 
         lowOut.store (TBase::outputs[LOW_OUTPUT].getVoltages (c));
@@ -167,6 +272,37 @@ inline void LaLaComp<TBase>::step()
     TBase::outputs[HIGH_OUTPUT].setChannels (channels);
 }
 
+template <class TBase>
+inline void LaLaComp<TBase>::stepMultiband (int channels, float freqParam)
+{
+    const int* outputIds = bandOutputs (lastBands);
+
+    std::array<float_4, sspo::LinkwitzRileyMultiband<float_4>::maxBands> bands;
+    for (auto c = 0; c < channels; c += 4)
+    {
+        auto fcv = TBase::inputs[FREQ_CV_INPUT].template getPolyVoltageSimd<float_4> (c);
+        fcv *= TBase::params[FREQ_CV_PARAM].getValue();
+        fcv += freqParam;
+        if (sspo::AudioMath::hasChanged (fcv, lastFcvs[c / 4]))
+        {
+            lastFcvs[c / 4] = fcv;
+            float_4 freq = dsp::FREQ_C4 * simd::pow (2.0f, fcv);
+            multibands[c / 4].setParameters (sr_4,
+                                             simd::clamp (freq * lowRatio, minFreq, maxFreq),
+                                             simd::clamp (freq, minFreq, maxFreq),
+                                             simd::clamp (freq * highRatio, minFreq, maxFreq));
+        }
+        float_4 in = TBase::inputs[MAIN_INPUT].template getPolyVoltageSimd<float_4> (c);
+        multibands[c / 4].process (in, bands);
+
+        for (auto b = 0; b < lastBands; ++b)
+            sspo::voltageSaturate (bands[b]).store (TBase::outputs[outputIds[b]].getVoltages (c));
+    }
+
+    for (auto b = 0; b < lastBands; ++b)
+        TBase::outputs[outputIds[b]].setChannels (channels);
+}
+
 template <class TBase>
 int LaLaDescription<TBase>::getNumParams()
 {
@@ -188,6 +324,12 @@ IComposite::Config LaLaDescription<TBase>::getParam (int i)
         case LaLaComp<TBase>::FREQ_CV_PARAM:
             ret = { -1.0f, 1.0f, 0.0f, "Frequency CV", " ", 0.0f, 1.0f, 0.0f };
             break;
+        case LaLaComp<TBase>::SPREAD_PARAM:
+            ret = { 0.5f, 4.0f, 2.0f, "Band spread", " octaves", 0.0f, 1.0f, 0.0f };
+            break;
+        case LaLaComp<TBase>::BANDS_PARAM:
+            ret = { 2.0f, 4.0f, 2.0f, "Bands", "", 0.0f, 1.0f, 0.0f };
+            break;
         default:
             assert (false);
     }
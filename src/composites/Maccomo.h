@@ -22,6 +22,9 @@
 #pragma once
 
 #include "IComposite.h"
+#include "PluginQuality.h"
+#include "PortSnapshot.h"
+#include "SilenceDetector.h"
 #include "SynthFilter.h"
 #include "AudioMath.h"
 #include <memory>
@@ -81,6 +84,7 @@ public:
         sampleRate = rate;
         sampleTime = 1.0f / rate;
         maxFreq = std::min (rate / 2.0f, 20000.0f);
+        silence.setSampleRate (rate);
     }
 
     // must be called after setSampleRate
@@ -96,7 +100,10 @@ public:
             f.setUseNonLinearProcessing (true);
             f.setType (sspo::MoogLadderFilter<float>::types()[0]);
             f.nonLinearProcess = [] (float in, float drive) { return std::tanh (in * drive); };
+            // used once High turns on the oversampling, minimum phase keeps the delay in the feedback loop short
+            f.setResampler (sspo::Resampler::FIR_MINIMUM);
         }
+        useOversample = false;
 
         sspo::AudioMath::defaultGenerator.seed (time (NULL));
     }
@@ -110,6 +117,7 @@ public:
         DRIVE_CV_ATTENUVERTER_PARAM,
         DRIVE_PARAM,
         MODE_PARAM,
+        QUALITY_OVERRIDE_PARAM,
         NUM_PARAMS
     };
 
@@ -140,75 +148,138 @@ public:
     static constexpr float maxRes = 10.0f;
     static constexpr float maxDrive = 2.0f;
     static constexpr int maxChannels = 16;
+    /// from here up the bootstrap noise alone can start the ladder ringing, the lowest is with the cutoff at the top of its range
+    static constexpr float selfOscillationResonance = 3.0f;
 
     static constexpr int typeCount = 6;
     std::vector<int> currentTypes;
 
     std::vector<sspo::MoogLadderFilter<float>> filters;
 
+    /// indices into cvIn
+    enum CvSnapshots
+    {
+        VOCT,
+        FREQ_CV,
+        RESONANCE_CV,
+        DRIVE_CV,
+        MODE_CV,
+        NUM_CV_SNAPSHOTS
+    };
+    InputSnapshot audioIn;
+    InputSnapshots<NUM_CV_SNAPSHOTS> cvIn;
+    OutputSnapshot audioOut;
+    SilenceDetector silence;
+
     void step() override;
 
     float sampleRate = 1.0f;
     float sampleTime = 1.0f;
+
+private:
+    /// only High oversamples the ladder's saturation
+    void readQuality();
+    bool useOversample = false;
+
+    /// the filter can make sound with no input, so it is kept out of idle
+    bool canSelfOscillate();
 };
 
+template <class TBase>
+inline bool MaccomoComp<TBase>::canSelfOscillate()
+{
+    const auto resonance = TBase::params[RESONANCE_PARAM].getValue()
+                           + SilenceDetector::peak (TBase::inputs[RESONANCE_CV_INPUT])
+                                 * std::abs (TBase::params[RESONANCE_CV_ATTENUVERTER_PARAM].getValue()) * maxRes / 5.0f;
+    return resonance >= selfOscillationResonance;
+}
+
+template <class TBase>
+inline void MaccomoComp<TBase>::readQuality()
+{
+    const auto level = sspo::PluginQuality::resolve (TBase::params[QUALITY_OVERRIDE_PARAM].getValue());
+    const auto oversample = level == sspo::PluginQuality::Level::HIGH;
+    if (oversample != useOversample)
+    {
+        useOversample = oversample;
+        for (auto& f : filters)
+            f.setUseOversample (oversample);
+    }
+}
+
 template <class TBase>
 inline void MaccomoComp<TBase>::step()
 {
-    auto channels = std::max (TBase::inputs[MAIN_INPUT].getChannels(),
-                              TBase::inputs[VOCT_INPUT].getChannels());
+    // audio is not spread across voices, a mono input only feeds the first filter
+    audioIn.read (TBase::inputs[MAIN_INPUT], false);
+    auto channels = std::max (audioIn.channels, TBase::inputs[VOCT_INPUT].getChannels());
     channels = std::max (channels, 1);
+
+    // the bootstrap noise is skipped while idle, so turning the resonance up wakes it
+    const auto selfOscillating = canSelfOscillate();
+    if (selfOscillating)
+        silence.keepAwake();
+    else if (silence.isIdle() && ! silence.wake (SilenceDetector::peak (TBase::inputs[MAIN_INPUT])))
+    {
+        SilenceDetector::writeSilence (TBase::outputs[MAIN_OUTPUT], channels);
+        return;
+    }
+
+    readQuality();
+    cvIn.read (TBase::inputs, { VOCT_INPUT, FREQ_CV_INPUT, RESONANCE_CV_INPUT, DRIVE_CV_INPUT, MODE_CV_INPUT });
+
     auto freqParam = TBase::params[FREQUENCY_PARAM].getValue();
     auto resParam = TBase::params[RESONANCE_PARAM].getValue();
     auto driveParam = TBase::params[DRIVE_PARAM].getValue();
     auto modeParam = static_cast<int> (TBase::params[MODE_PARAM].getValue());
-    auto freqAttenuverterParam = TBase::params[FREQUENCY_CV_ATTENUVERTER_PARAM].getValue();
-    auto resAttenuverterParam = TBase::params[RESONANCE_CV_ATTENUVERTER_PARAM].getValue();
-    auto driveAttenuverterParam = TBase::params[DRIVE_CV_ATTENUVERTER_PARAM].getValue();
+    auto freqAttenuverterParam = cvIn.isConnected (FREQ_CV)
+                                     ? TBase::params[FREQUENCY_CV_ATTENUVERTER_PARAM].getValue()
+                                     : 0.0f;
+    auto voctScale = cvIn.isConnected (VOCT) ? 1.0f : 0.0f;
+    auto resAttenuverterParam = TBase::params[RESONANCE_CV_ATTENUVERTER_PARAM].getValue() * maxRes / 5.0f;
+    auto driveAttenuverterParam = TBase::params[DRIVE_CV_ATTENUVERTER_PARAM].getValue() * maxDrive / 5.0f;
 
     freqParam = freqParam * 10.0f - 5.0f;
 
+    float frequency[maxChannels];
+    float resonance[maxChannels];
+    float drive[maxChannels];
+    for (auto i = 0; i < maxChannels; ++i)
+    {
+        frequency[i] = freqParam
+                       + cvIn[VOCT][i] * voctScale
+                       + cvIn[FREQ_CV][i] * freqAttenuverterParam;
+        resonance[i] = clamp (resParam + cvIn[RESONANCE_CV][i] * resAttenuverterParam, 0.0f, maxRes);
+        drive[i] = clamp (driveParam + cvIn[DRIVE_CV][i] * driveAttenuverterParam, 0.0f, maxDrive);
+    }
+
     for (auto i = 0; i < channels; ++i)
     {
-        auto in = TBase::inputs[MAIN_INPUT].getVoltage (i);
         // Add -120dB noise to bootstrap self-oscillation
-        in += 1e-6f * (2.f * sspo::AudioMath::rand01() - 1.f);
+        auto in = audioIn[i] + 1e-6f * (2.f * sspo::AudioMath::rand01() - 1.f);
 
-        auto frequency = freqParam;
-        if (TBase::inputs[VOCT_INPUT].isConnected())
-            frequency += TBase::inputs[VOCT_INPUT].getPolyVoltage (i);
-        if (TBase::inputs[FREQ_CV_INPUT].isConnected())
-        {
-            frequency += (TBase::inputs[FREQ_CV_INPUT].getPolyVoltage (i)
-                          * freqAttenuverterParam);
-        }
-        frequency = dsp::FREQ_C4 * std::pow (2.0f, frequency);
+        auto freq = clamp (dsp::FREQ_C4 * std::pow (2.0f, frequency[i]), 0.0f, maxFreq);
 
-        frequency = clamp (frequency, 0.0f, maxFreq);
-
-        auto resonance = resParam;
-        resonance += (TBase::inputs[RESONANCE_CV_INPUT].getPolyVoltage (i) / 5.0f)
-                     * resAttenuverterParam * maxRes;
-        resonance = clamp (resonance, 0.0f, maxRes);
-
-        auto drive = driveParam;
-        drive += (TBase::inputs[DRIVE_CV_INPUT].getPolyVoltage (i) / 5.0f)
-                 * driveAttenuverterParam * maxDrive;
-        drive = clamp (drive, 0.0f, maxDrive);
-
-        if (currentTypes[i] != modeParam + int (TBase::inputs[MODE_CV_INPUT].getPolyVoltage (i)))
+        auto type = modeParam + int (cvIn[MODE_CV][i]);
+        if (currentTypes[i] != type)
         {
-            currentTypes[i] = clamp (modeParam + int (TBase::inputs[MODE_CV_INPUT].getPolyVoltage (i)), 0, typeCount - 1);
+            currentTypes[i] = clamp (type, 0, typeCount - 1);
             filters[i].setType (sspo::MoogLadderFilter<float>::types()[currentTypes[i]]);
         }
 
-        filters[i].setParameters (frequency, resonance, drive, 0, sampleRate);
+        filters[i].setParameters (freq, resonance[i], drive[i], 0, sampleRate);
 
         auto out = filters[i].process (in / 10.0f) * 10.0f;
-        out = std::isfinite (out) ? out : 0;
-        TBase::outputs[MAIN_OUTPUT].setVoltage (out, i);
+        audioOut[i] = std::isfinite (out) ? out : 0;
+    }
+    audioOut.write (TBase::outputs[MAIN_OUTPUT], channels);
+
+    if (! selfOscillating
+        && silence.process (SilenceDetector::peak (TBase::inputs[MAIN_INPUT]), SilenceDetector::peak (TBase::outputs[MAIN_OUTPUT])))
+    {
+        for (auto& f : filters)
+            f.reset();
     }
-    TBase::outputs[MAIN_OUTPUT].setChannels (channels);
 }
 
 template <class TBase>
@@ -246,6 +317,9 @@ IComposite::Config MaccomoDescription<TBase>::getParam (int i)
         case MaccomoComp<TBase>::MODE_PARAM:
             ret = { 0.0f, MaccomoComp<TBase>::typeCount - 1, 0.0f, "Type", " ", 0.0f, 1.0f, 0.0f };
             break;
+        case MaccomoComp<TBase>::QUALITY_OVERRIDE_PARAM:
+            ret = sspo::PluginQuality::overrideConfig();
+            break;
         default:
             assert (false);
     }
@@ -22,6 +22,7 @@
 #pragma once
 
 #include "IComposite.h"
+#include "PortSnapshot.h"
 #include "AudioMath.h"
 #include <algorithm>
 #include <cstdlib>
@@ -301,6 +302,17 @@ public:
      */
     void step() override;
     typedef float T; // use floats for all signals
+
+private:
+    /// indices into probabilityIn
+    enum ProbabilitySnapshots
+    {
+        TRIGGER_PROB,
+        SHUFFLE_PROB,
+        NUM_PROBABILITY_SNAPSHOTS
+    };
+    InputSnapshots<NUM_PROBABILITY_SNAPSHOTS> probabilityIn;
+    OutputSnapshot out;
 };
 
 template <class TBase>
@@ -330,18 +342,22 @@ inline void PolyShiftRegisterComp<TBase>::step()
     //write ignore status to channel 0
     //expMessage->triggerAccent[0] = ignoreTrigger;
 
-    auto shifted = false;
+    probabilityIn.read (TBase::inputs, { TRIGGER_PROB_INPUT, SHUFFLE_PROB_INPUT });
+    const auto triggerProbParam = TBase::params[TRIGGER_PROB_PARAM].getValue();
+    const auto shuffleProbParam = TBase::params[SHUFFLE_PROB_PARAM].getValue();
+    float triggerProbs[maxChannels];
+    float shuffleProbs[maxChannels];
     for (auto c = 0; c < maxChannels; ++c)
     {
-        triggerProb = clamp (TBase::params[TRIGGER_PROB_PARAM].getValue()
-                                 + TBase::inputs[TRIGGER_PROB_INPUT].getPolyVoltage (c) / 10.0f,
-                             0.0f,
-                             1.0f);
+        triggerProbs[c] = clamp (triggerProbParam + probabilityIn[TRIGGER_PROB][c] / 10.0f, 0.0f, 1.0f);
+        shuffleProbs[c] = clamp (shuffleProbParam + probabilityIn[SHUFFLE_PROB][c] / 10.0f, 0.0f, 1.0f);
+    }
 
-        shuffleProb = clamp (TBase::params[SHUFFLE_PROB_PARAM].getValue()
-                                 + TBase::inputs[SHUFFLE_PROB_INPUT].getPolyVoltage (c) / 10.0f,
-                             0.0f,
-                             1.0f);
+    auto shifted = false;
+    for (auto c = 0; c < maxChannels; ++c)
+    {
+        triggerProb = triggerProbs[c];
+        shuffleProb = shuffleProbs[c];
 
         if (! monoTriggerProb)
             ignoreTrigger = triggerProb > rand01();
@@ -377,17 +393,11 @@ inline void PolyShiftRegisterComp<TBase>::step()
         expMessage->reset.set();
     }
     //output channels
-    for (auto c = 0; c < std::min (currentChannels, channels); ++c)
-    {
-        auto out = channelData[c][c];
-        out += accentAOffsets[c];
-        out += accentBOffsets[c];
-        out += accentRngOffsets[c];
-        TBase::outputs[MAIN_OUTPUT].setVoltage (out, c);
-    }
+    for (auto c = 0; c < maxChannels; ++c)
+        out[c] = channelData[c][c] + accentAOffsets[c] + accentBOffsets[c] + accentRngOffsets[c];
 
     expMessage->currentChannels = currentChannels;
-    TBase::outputs[MAIN_OUTPUT].setChannels (std::min (currentChannels, channels));
+    out.write (TBase::outputs[MAIN_OUTPUT], std::min (currentChannels, channels));
 }
 
 template <class TBase>
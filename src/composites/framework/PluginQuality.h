@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2020 Dave French <contact/dot/dave/dot/french3/at/googlemail/dot/com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include "IComposite.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace sspo
+{
+    /**
+     * The plugin wide trade off between cpu and quality, Eco, Normal or High.
+     *
+     * plugin.cpp loads and saves the setting in the plugin settings file.
+     * Each composite that uses it has a hidden override param, 0 follows the plugin setting
+     * and 1 to 3 pin that module to Eco, Normal or High from its context menu.
+     * Composites resolve the level at their control or refresh rate and pick their oversampling,
+     * control rate division, interpolation and refresh dividers from it.
+     */
+    namespace PluginQuality
+    {
+        enum class Level
+        {
+            ECO,
+            NORMAL,
+            HIGH,
+            COUNT
+        };
+
+        /// the override param value that follows the plugin setting
+        constexpr int followPlugin = 0;
+
+        /// one store for the whole plugin, written from the ui thread and read by the engine
+        inline std::atomic<int>& pluginSetting()
+        {
+            static std::atomic<int> level{ static_cast<int> (Level::NORMAL) };
+            return level;
+        }
+
+        inline Level getPluginLevel()
+        {
+            return static_cast<Level> (pluginSetting().load (std::memory_order_relaxed));
+        }
+
+        inline void setPluginLevel (Level level)
+        {
+            const auto l = std::min (std::max (static_cast<int> (level), 0), static_cast<int> (Level::COUNT) - 1);
+            pluginSetting().store (l, std::memory_order_relaxed);
+        }
+
+        /// a module's level from its override param
+        inline Level resolve (float overrideParam)
+        {
+            const auto o = static_cast<int> (overrideParam);
+            if (o <= followPlugin || o > static_cast<int> (Level::COUNT))
+                return getPluginLevel();
+            return static_cast<Level> (o - 1);
+        }
+
+        template <typename T>
+        T select (Level level, T eco, T normal, T high)
+        {
+            switch (level)
+            {
+                case Level::ECO:
+                    return eco;
+                case Level::HIGH:
+                    return high;
+                default:
+                    return normal;
+            }
+        }
+
+        /// refresh dividers run at half the rate in Eco and twice the rate in High
+        inline int scaleDivision (int normal, Level level)
+        {
+            return select (level, normal * 2, normal, std::max (normal / 2, 1));
+        }
+
+        inline const char* name (Level level)
+        {
+            return select (level, "Eco", "Normal", "High");
+        }
+
+        /// every composite's override param is set up the same way
+        inline IComposite::Config overrideConfig()
+        {
+            return { 0.0f, static_cast<float> (Level::COUNT), static_cast<float> (followPlugin), "Quality", " ", 0, 1, 0.0f };
+        }
+    } // namespace PluginQuality
+} // namespace sspo
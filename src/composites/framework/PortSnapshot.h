@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2020 Dave French <contact/dot/dave/dot/french3/at/googlemail/dot/com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include "simd/functions.hpp"
+
+#include <array>
+#include <cstdint>
+
+/**
+ * Per step copies of polyphonic ports, shared by TestComposite and WidgetComposite composites.
+ *
+ * Inputs are read into an aligned array once per step, so voice loops become plain array code
+ * instead of a getPolyVoltage() call and connection check per channel.
+ */
+struct alignas (16) InputSnapshot
+{
+    using float_4 = rack::simd::float_4;
+    static constexpr int maxChannels = 16;
+
+    float voltages[maxChannels] = {};
+    int channels = 0;
+
+    /// copy the port, a mono cable is copied to every channel unless broadcastMono is false
+    template <typename TPort>
+    void read (TPort& port, bool broadcastMono = true)
+    {
+        channels = port.getChannels();
+        if (channels == 1 && broadcastMono)
+        {
+            const auto v = port.getVoltage (0);
+            for (auto c = 0; c < maxChannels; ++c)
+                voltages[c] = v;
+        }
+        else
+        {
+            // channels above the cable's count are 0V in Rack, so a whole group is safe to copy
+            for (auto c = 0; c < maxChannels; c += 4)
+                port.template getVoltageSimd<float_4> (c).store (&voltages[c]);
+        }
+    }
+
+    bool isConnected() const
+    {
+        return channels > 0;
+    }
+
+    float operator[] (int channel) const
+    {
+        return voltages[channel];
+    }
+
+    float_4 getSimd (int firstChannel) const
+    {
+        return float_4::load (&voltages[firstChannel]);
+    }
+};
+
+/// A set of input snapshots, with a bit set in connected for each input that has a cable
+template <int N>
+struct InputSnapshots
+{
+    std::array<InputSnapshot, N> inputs;
+    uint32_t connected = 0;
+
+    /// ids[i] is the composite's input id to copy into inputs[i]
+    template <typename TPorts>
+    void read (TPorts& ports, const std::array<int, N>& ids)
+    {
+        connected = 0;
+        for (auto i = 0; i < N; ++i)
+        {
+            inputs[i].read (ports[ids[i]]);
+            if (inputs[i].isConnected())
+                connected |= 1u << i;
+        }
+    }
+
+    bool isConnected (int i) const
+    {
+        return connected & (1u << i);
+    }
+
+    const InputSnapshot& operator[] (int i) const
+    {
+        return inputs[i];
+    }
+};
+
+/// Output voltages for this step, written to the port a group of four at a time
+struct alignas (16) OutputSnapshot
+{
+    using float_4 = rack::simd::float_4;
+    static constexpr int maxChannels = 16;
+
+    float voltages[maxChannels] = {};
+
+    float& operator[] (int channel)
+    {
+        return voltages[channel];
+    }
+
+    void setSimd (float_4 v, int firstChannel)
+    {
+        v.store (&voltages[firstChannel]);
+    }
+
+    template <typename TPort>
+    void write (TPort& port, int channels)
+    {
+        // unused channels must stay at 0V, the last group may be partly used
+        for (auto c = channels; c < maxChannels; ++c)
+            voltages[c] = 0.0f;
+        for (auto c = 0; c < channels; c += 4)
+            port.setVoltageSimd (float_4::load (&voltages[c]), c);
+        port.setChannels (channels);
+    }
+};
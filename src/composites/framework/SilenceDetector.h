@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2020 Dave French <contact/dot/dave/dot/french3/at/googlemail/dot/com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include "simd/functions.hpp"
+
+#include <algorithm>
+
+/**
+ * Lets an effect composite stop processing while it has nothing to do.
+ *
+ * After every processed step the composite passes its input and output peaks to process().
+ * Once both have stayed below sleepLevel for the hold time the detector goes idle,
+ * the output is part of it so a filter ring or comb feedback tail plays out before it stops.
+ * While idle the composite writes zeros and only checks its input with wake(),
+ * which has to reach the higher wakeLevel, so noise around the sleep level can't make it stutter.
+ * The step that wakes it is processed as normal, so the first sample of new input is never lost.
+ */
+class SilenceDetector
+{
+public:
+    using float_4 = rack::simd::float_4;
+
+    /// -100dB and -94dB from 10V
+    static constexpr float sleepLevel = 1.0e-4f;
+    static constexpr float wakeLevel = 2.0e-4f;
+    static constexpr float holdTime = 0.5f;
+
+    void setSampleRate (float sampleRate)
+    {
+        holdSamples = static_cast<int> (holdTime * sampleRate);
+    }
+
+    bool isIdle() const
+    {
+        return idle;
+    }
+
+    /// peaks from a processed step, returns true on the step it goes idle
+    bool process (float inputPeak, float outputPeak)
+    {
+        if (std::max (inputPeak, outputPeak) > sleepLevel)
+        {
+            quietSamples = 0;
+            return false;
+        }
+        if (++quietSamples < holdSamples)
+            return false;
+        idle = true;
+        return true;
+    }
+
+    /// while idle, true when the input has come back and this step should be processed
+    bool wake (float inputPeak)
+    {
+        if (inputPeak < wakeLevel)
+            return false;
+        idle = false;
+        quietSamples = 0;
+        return true;
+    }
+
+    /// for a composite that can make sound from silence, such as a self oscillating filter
+    void keepAwake()
+    {
+        quietSamples = 0;
+        idle = false;
+    }
+
+    /// largest absolute voltage on the port's channels
+    template <typename TPort>
+    static float peak (TPort& port)
+    {
+        const auto channels = port.getChannels();
+        float_4 ret = 0.0f;
+        for (auto c = 0; c < channels; c += 4)
+        {
+            // voltages past the channel count in the last group may be stale
+            const float_4 used = float_4 (c, c + 1, c + 2, c + 3) < float_4 (static_cast<float> (channels));
+            ret = rack::simd::fmax (ret, rack::simd::ifelse (used, rack::simd::abs (port.template getVoltageSimd<float_4> (c)), 0.0f));
+        }
+        return std::max (std::max (ret[0], ret[1]), std::max (ret[2], ret[3]));
+    }
+
+    /// the output of an idle composite, exact zeros on the channels it would have used
+    template <typename TPort>
+    static void writeSilence (TPort& port, int channels)
+    {
+        // a port left with no channels still keeps one for Rack, so that one is cleared too
+        for (auto c = 0; c < std::max (channels, 1); c += 4)
+            port.setVoltageSimd (float_4 (0.0f), c);
+        port.setChannels (channels);
+    }
+
+private:
+    bool idle = false;
+    int quietSamples = 0;
+    int holdSamples = static_cast<int> (holdTime * 44100.0f);
+};
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2020 Dave French <contact/dot/dave/dot/french3/at/googlemail/dot/com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include "plugin.hpp"
+#include "PluginQuality.h"
+#include "SqMenuItem.h"
+
+#include <string>
+
+namespace sspo
+{
+    /// The quality section of a module's context menu.
+    /// The module's override param can follow the plugin, or be set to a level for this module only.
+    /// The plugin level is shared by every module and saved in the plugin settings straight away.
+    inline void appendQualityMenu (Menu* menu, Module* module, int overrideParamId)
+    {
+        using namespace PluginQuality;
+        const auto levels = static_cast<int> (Level::COUNT);
+
+        menu->addChild (new MenuEntry);
+        auto* moduleLabel = new MenuLabel();
+        moduleLabel->text = "Quality, this module";
+        menu->addChild (moduleLabel);
+
+        for (auto i = followPlugin; i <= levels; ++i)
+        {
+            auto* item = new SqMenuItem (
+                [module, overrideParamId, i]() { return static_cast<int> (module->params[overrideParamId].getValue()) == i; },
+                [module, overrideParamId, i]() { module->params[overrideParamId].setValue (static_cast<float> (i)); });
+            item->text = i == followPlugin ? std::string ("Plugin default (") + name (getPluginLevel()) + ")"
+                                           : std::string (name (static_cast<Level> (i - 1)));
+            menu->addChild (item);
+        }
+
+        auto* pluginLabel = new MenuLabel();
+        pluginLabel->text = "Quality, plugin default";
+        menu->addChild (pluginLabel);
+
+        for (auto i = 0; i < levels; ++i)
+        {
+            const auto level = static_cast<Level> (i);
+            auto* item = new SqMenuItem (
+                [level]() { return getPluginLevel() == level; },
+                [level]() {
+                    setPluginLevel (level);
+                    savePluginSettings();
+                });
+            item->text = name (level);
+            menu->addChild (item);
+        }
+    }
+} // namespace sspo
@@ -23,7 +23,9 @@
 
 #include <stdio.h>
 #include <algorithm>
+#include <cstdint>
 #include <cmath>
+#include <complex>
 #include <float.h>
 #include <vector>
 #include <random>
@@ -55,6 +57,18 @@ namespace sspo
             return x * (27 + x * x) / (27 + 9 * x * x);
         }
 
+        /// sin (2 pi phase) for any phase, branchless so float_4 lanes may hold unrelated phases.
+        /// The phase is folded to a quarter cycle for an odd minimax polynomial, error is around 1e-6
+        template <typename T>
+        inline T fastSin2Pi (const T phase)
+        {
+            // sin (2 pi p) == cos (2 pi (p - 1/4)), and cos only depends on the distance to the nearest whole cycle
+            T t = phase - 0.25f;
+            T x = 0.25f - rack::simd::abs (t - rack::simd::floor (t + 0.5f));
+            T x2 = x * x;
+            return x * (6.283164044f + x2 * (-41.33714237f + x2 * (81.34076887f + x2 * -70.99343310f)));
+        }
+
         template <typename T>
         inline bool areSame (T a, T b, T delta = FLT_EPSILON) noexcept
         {
@@ -77,6 +91,39 @@ namespace sspo
             return frac * (v1 - v0) + v0;
         }
 
+        /// in place radix 2 fft for building tables and filter designs, not for audio rate use.
+        /// The size must be a power of 2, the inverse is unscaled
+        inline void fft (std::vector<std::complex<double>>& x, const bool inverse)
+        {
+            const auto n = x.size();
+            for (size_t i = 1, j = 0; i < n; ++i)
+            {
+                auto bit = n >> 1;
+                for (; j & bit; bit >>= 1)
+                    j ^= bit;
+                j ^= bit;
+                if (i < j)
+                    std::swap (x[i], x[j]);
+            }
+            for (size_t len = 2; len <= n; len <<= 1)
+            {
+                auto angle = 2.0 * LD_PI / len * (inverse ? 1.0 : -1.0);
+                std::complex<double> w (std::cos (angle), std::sin (angle));
+                for (size_t i = 0; i < n; i += len)
+                {
+                    std::complex<double> wn (1.0, 0.0);
+                    for (size_t k = 0; k < len / 2; ++k)
+                    {
+                        auto u = x[i + k];
+                        auto v = x[i + k + len / 2] * wn;
+                        x[i + k] = u + v;
+                        x[i + k + len / 2] = u - v;
+                        wn *= w;
+                    }
+                }
+            }
+        }
+
         template <typename T>
         class ZeroCrossing
         {
@@ -105,6 +152,45 @@ namespace sspo
             return distribution (defaultGenerator);
         }
 
+        /// Per instance uniform noise in [-0.5, 0.5), four independent lanes.
+        /// A linear congruential generator per lane, cheap enough to dither every sample of an oscillator
+        class NoiseSource4
+        {
+        public:
+            explicit NoiseSource4 (uint32_t seed = 1)
+            {
+                setSeed (seed);
+            }
+
+            void setSeed (uint32_t seed)
+            {
+                state = rack::simd::int32_4 (static_cast<int32_t> (seed),
+                                             static_cast<int32_t> (seed ^ 0x9e3779b9u),
+                                             static_cast<int32_t> (seed ^ 0x7f4a7c15u),
+                                             static_cast<int32_t> (seed ^ 0x3c6ef372u));
+            }
+
+            rack::simd::float_4 process()
+            {
+                state = state * rack::simd::int32_4 (1664525) + rack::simd::int32_4 (1013904223);
+                return rack::simd::float_4 (state) * (1.0f / 4294967296.0f);
+            }
+
+        private:
+            rack::simd::int32_4 state;
+        };
+
+        /// true when any lane differs, used to skip coefficient recalculation
+        inline bool hasChanged (const float a, const float b) noexcept
+        {
+            return a != b;
+        }
+
+        inline bool hasChanged (const rack::simd::float_4 a, const rack::simd::float_4 b) noexcept
+        {
+            return rack::simd::movemask (a != b) != 0;
+        }
+
         inline float db (float g)
         {
             return 20 * log (g) / Ln10;
@@ -21,8 +21,10 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cmath>
 #include <memory>
+#include <vector>
 
 #include "AudioMath.h"
 
@@ -87,3 +89,105 @@ private:
     unsigned int bufferLength{ 0 };
     unsigned int wrapBits{ 0 };
 };
+
+/// Circular buffer of float_4, one lane for each of four voices
+/// The four voices are written with one store, and read from the same cache lines.
+class InterleavedCircularBuffer
+{
+public:
+    using float_4 = rack::simd::float_4;
+
+    InterleavedCircularBuffer()
+    {
+        reset (4096);
+    }
+
+    void reset (const unsigned int minBufferSize)
+    {
+        writeIndex = 0;
+        bufferLength = static_cast<unsigned int> (std::pow (2, std::ceil (std::log (minBufferSize) / std::log (2))));
+        wrapBits = bufferLength - 1;
+        buffer.resize (bufferLength);
+        clear();
+    }
+
+    void clear()
+    {
+        std::fill (buffer.begin(), buffer.end(), float_4 (0.0f));
+    }
+
+    /// zero the lanes set in mask, leaving the other voices alone
+    void clearLanes (const float_4 mask)
+    {
+        for (auto& frame : buffer)
+            frame = rack::simd::ifelse (mask, 0.0f, frame);
+    }
+
+    inline void writeBuffer (const float_4 newValue) noexcept
+    {
+        writeIndex++;
+        writeIndex &= wrapBits;
+        // nan fails the comparison, so is also set to 0
+        buffer[writeIndex] = rack::simd::ifelse (rack::simd::abs (newValue) < INFINITY, newValue, 0.0f);
+    }
+
+    /// each lane reads its own delay, linear interpolated
+    inline float_4 readBuffer (const float_4 delaySamples) const noexcept
+    {
+        float_4 whole = rack::simd::trunc (delaySamples);
+        float_4 y1;
+        float_4 y2;
+        for (auto i = 0; i < 4; ++i)
+        {
+            auto index = writeIndex - static_cast<int> (whole[i]);
+            y1[i] = buffer[index & wrapBits][i];
+            y2[i] = buffer[(index - 1) & wrapBits][i];
+        }
+        return sspo::AudioMath::linearInterpolate (y1, y2, delaySamples - whole);
+    }
+
+    /// each lane reads its own delay, 4 point Hermite interpolated, for swept delays
+    /// the delay must be at least 1 sample
+    inline float_4 readBufferCubic (const float_4 delaySamples) const noexcept
+    {
+        float_4 whole = rack::simd::trunc (delaySamples);
+        float_4 ym1;
+        float_4 y0;
+        float_4 y1;
+        float_4 y2;
+        for (auto i = 0; i < 4; ++i)
+        {
+            auto index = writeIndex - static_cast<int> (whole[i]);
+            ym1[i] = buffer[(index + 1) & wrapBits][i];
+            y0[i] = buffer[index & wrapBits][i];
+            y1[i] = buffer[(index - 1) & wrapBits][i];
+            y2[i] = buffer[(index - 2) & wrapBits][i];
+        }
+        float_4 x = delaySamples - whole;
+        float_4 c0 = y0;
+        float_4 c1 = 0.5f * (y1 - ym1);
+        float_4 c2 = ym1 - 2.5f * y0 + 2.0f * y1 - 0.5f * y2;
+        float_4 c3 = 0.5f * (y2 - ym1) + 1.5f * (y0 - y1);
+        return ((c3 * x + c2) * x + c1) * x + c0;
+    }
+
+    /// weighted sum of count taps, each lane reading its own delays
+    inline float_4 readTaps (const float_4* delaySamples, const float_4* levels, const int count) const noexcept
+    {
+        float_4 sum = 0.0f;
+        for (auto t = 0; t < count; ++t)
+            sum += readBuffer (delaySamples[t]) * levels[t];
+        return sum;
+    }
+
+    int size()
+    {
+        return static_cast<int> (bufferLength);
+    }
+
+private:
+    std::vector<float_4> buffer;
+    unsigned int writeIndex{ 0 };
+    unsigned int bufferLength{ 0 };
+    unsigned int wrapBits{ 0 };
+};
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2020 Dave French <contact/dot/dave/dot/french3/at/googlemail/dot/com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include "AudioMath.h"
+#include "digital.hpp"
+#include "simd/functions.hpp"
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace sspo
+{
+    /// Excitation for the plucked string models, a gate starts a burst on each voice.
+    /// The bursts are precomputed when the sample rate is set, playback is a table read per voice.
+    /// Voices are handled four at a time, one per float_4 lane.
+    class ExciterBank
+    {
+    public:
+        using float_4 = rack::simd::float_4;
+
+        enum class Shape
+        {
+            OFF,
+            WHITE_NOISE,
+            PINK_NOISE,
+            PLUCK,
+            BOW,
+            COUNT
+        };
+
+        ExciterBank (int groups = 4)
+        {
+            setGroups (groups);
+            setSampleRate (44100.0f);
+        }
+
+        void setGroups (int groups)
+        {
+            voices.resize (groups);
+            for (auto& v : voices)
+                v = Voice();
+        }
+
+        void setSampleRate (float sampleRate)
+        {
+            // fixed seed, the same burst every time
+            std::minstd_rand generator{ 1 };
+            std::uniform_real_distribution<float> white{ -1.0f, 1.0f };
+
+            const auto burstLength = static_cast<int> (0.05f * sampleRate);
+            const auto bowLength = static_cast<int> (sampleRate);
+            const auto decay = std::exp (-1.0f / (0.008f * sampleRate));
+            const auto pluckDecay = std::exp (-1.0f / (0.003f * sampleRate));
+            const auto pluckCoefficient = 1.0f - std::exp (-AudioMath::k_2pi * 1500.0f / sampleRate);
+            const auto bowCoefficient = 1.0f - std::exp (-AudioMath::k_2pi * 3000.0f / sampleRate);
+
+            for (auto& table : tables)
+                table.clear();
+
+            auto& whiteTable = tables[static_cast<int> (Shape::WHITE_NOISE)];
+            auto& pinkTable = tables[static_cast<int> (Shape::PINK_NOISE)];
+            auto& pluckTable = tables[static_cast<int> (Shape::PLUCK)];
+            auto& bowTable = tables[static_cast<int> (Shape::BOW)];
+
+            // Paul Kellet's economy pink filter
+            float b0 = 0.0f;
+            float b1 = 0.0f;
+            float b2 = 0.0f;
+            float lp1 = 0.0f;
+            float lp2 = 0.0f;
+            float envelope = 1.0f;
+            float pluckEnvelope = 1.0f;
+            for (auto i = 0; i < burstLength; ++i)
+            {
+                auto x = white (generator);
+                b0 = 0.99765f * b0 + x * 0.0990460f;
+                b1 = 0.96300f * b1 + x * 0.2965164f;
+                b2 = 0.57000f * b2 + x * 1.0526913f;
+                auto pink = b0 + b1 + b2 + x * 0.1848f;
+                lp1 += pluckCoefficient * (x - lp1);
+                lp2 += pluckCoefficient * (lp1 - lp2);
+
+                whiteTable.push_back (x * envelope);
+                pinkTable.push_back (pink * envelope);
+                pluckTable.push_back (lp2 * pluckEnvelope);
+                envelope *= decay;
+                pluckEnvelope *= pluckDecay;
+            }
+
+            float lp = 0.0f;
+            for (auto i = 0; i < bowLength; ++i)
+            {
+                lp += bowCoefficient * (white (generator) - lp);
+                bowTable.push_back (lp);
+            }
+
+            for (auto& table : tables)
+                normalise (table);
+
+            attack = 1.0f - std::exp (-1.0f / (0.02f * sampleRate));
+            release = 1.0f - std::exp (-1.0f / (0.05f * sampleRate));
+        }
+
+        void setShape (Shape s)
+        {
+            shape = s;
+        }
+
+        Shape getShape() const
+        {
+            return shape;
+        }
+
+        /// every group of four voices at once, one gate and one excitation in +-5V per group.
+        /// A single call per sample keeps the per group work inline.
+        void process (const float_4* gates, float_4* excitation, int groups)
+        {
+            if (shape == Shape::OFF)
+            {
+                for (auto g = 0; g < groups; ++g)
+                {
+                    voices[g].trigger.process (gates[g]);
+                    excitation[g] = 0.0f;
+                }
+                return;
+            }
+
+            // the read positions are plain ints, a table read per lane needs no conversions
+            const auto& table = tables[static_cast<int> (shape)];
+            const auto* samples = table.data();
+            const auto length = static_cast<int> (table.size());
+            float out[4];
+            if (shape == Shape::BOW)
+            {
+                // noise loops while the gate is held, with a short swell and fade
+                for (auto g = 0; g < groups; ++g)
+                {
+                    auto& voice = voices[g];
+                    const auto triggered = rack::simd::movemask (voice.trigger.process (gates[g]));
+                    float_4 target = rack::simd::ifelse (voice.trigger.isHigh(), 1.0f, 0.0f);
+                    float_4 rate = rack::simd::ifelse (target > voice.level, attack, release);
+                    voice.level += (target - voice.level) * rate;
+                    for (auto i = 0; i < 4; ++i)
+                    {
+                        auto& position = voice.position[i];
+                        if ((triggered & (1 << i)) || position >= length)
+                            position = 0;
+                        out[i] = samples[position++];
+                    }
+                    excitation[g] = float_4 (out[0], out[1], out[2], out[3]) * voice.level * 5.0f;
+                }
+                return;
+            }
+
+            for (auto g = 0; g < groups; ++g)
+            {
+                auto& voice = voices[g];
+                const auto triggered = rack::simd::movemask (voice.trigger.process (gates[g]));
+                for (auto i = 0; i < 4; ++i)
+                {
+                    auto& position = voice.position[i];
+                    if (triggered & (1 << i))
+                        position = 0;
+                    out[i] = position < length ? samples[position++] : 0.0f;
+                }
+                excitation[g] = float_4 (out[0], out[1], out[2], out[3]) * 5.0f;
+            }
+        }
+
+    private:
+        struct Voice
+        {
+            rack::dsp::TSchmittTrigger<float_4> trigger;
+            // past the end of every burst, so nothing plays until the first gate
+            int position[4] = { idle, idle, idle, idle };
+            float_4 level = 0.0f;
+        };
+
+        static constexpr int idle = std::numeric_limits<int>::max();
+
+        static void normalise (std::vector<float>& table)
+        {
+            auto peak = 0.0f;
+            for (auto x : table)
+                peak = std::max (peak, std::abs (x));
+            if (peak > 0.0f)
+            {
+                for (auto& x : table)
+                    x /= peak;
+            }
+        }
+
+        std::array<std::vector<float>, static_cast<int> (Shape::COUNT)> tables;
+        std::vector<Voice> voices;
+        Shape shape = Shape::OFF;
+        float attack = 0.001f;
+        float release = 0.001f;
+    };
+
+} // namespace sspo
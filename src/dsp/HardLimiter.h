@@ -41,23 +41,37 @@ namespace sspo
     ///
     /// !A fixed parameter limiter
     /// Based on description given in Prikle, Designing Audio Effects 2nd
+    /// T float, or float_4 to limit four voices together, each lane has its own envelope
     ///
-    struct Compressor
+    template <typename T>
+    struct TCompressor
     {
-        Compressor()
+        TCompressor()
         {
             divider.setDivision (divFreq);
         }
 
         void calcCoeffs()
         {
-            attackCoeff = simd::exp (TC / (sampleRate * attackTime));
-            releaseCoeff = simd::exp (TC / (sampleRate * releaseTimes));
+            // the envelope only runs every divFreq samples
+            const auto envelopeRate = sampleRate / divFreq;
+            attackCoeff = simd::exp (TC / (envelopeRate * attackTime));
+            releaseCoeff = simd::exp (TC / (envelopeRate * releaseTimes));
         }
 
         void setSampleRate (const float sr)
         {
-            sampleRate = sr / divFreq;
+            sampleRate = sr;
+            calcCoeffs();
+        }
+
+        /// the envelope runs every division samples
+        void setDivision (const int division)
+        {
+            if (division == divFreq)
+                return;
+            divFreq = division;
+            divider.setDivision (divFreq);
             calcCoeffs();
         }
 
@@ -67,24 +81,24 @@ namespace sspo
             releaseTimes = release;
             calcCoeffs();
         }
-        float G = 0.0;
-        float process (const float in)
+        T G = 0.0f;
+        T process (const T in)
         {
             if (divider.process())
             {
                 //envelope follower
-                auto rectIn = std::abs (in);
-                currentEnv = rectIn > lastEnv
-                                 ? attackCoeff * (lastEnv - rectIn) + rectIn
-                                 : releaseCoeff * (lastEnv - rectIn) + rectIn;
-                currentEnv = std::max (currentEnv, 0.00000000001f);
+                T rectIn = simd::abs (in);
+                currentEnv = simd::ifelse (rectIn > lastEnv,
+                                           attackCoeff * (lastEnv - rectIn) + rectIn,
+                                           releaseCoeff * (lastEnv - rectIn) + rectIn);
+                currentEnv = simd::fmax (currentEnv, T (0.00000000001f));
                 lastEnv = currentEnv;
 
                 //            auto dn = 20.0f * lookup.log10 (currentEnv);
-                auto dn = 20.0f * simd::log10 (currentEnv);
+                T dn = 20.0f * simd::log10 (currentEnv);
                 //Hard knee compression
-                auto yndB = dn <= threshold ? dn : threshold + ((dn - threshold) / ratio);
-                auto gndB = yndB - dn;
+                T yndB = simd::ifelse (dn <= threshold, dn, threshold + ((dn - threshold) / ratio));
+                T gndB = yndB - dn;
                 G = simd::pow (10.0f, gndB / 20.0f);
             }
 
@@ -99,15 +113,17 @@ namespace sspo
     private:
         float attackCoeff{ 0.0f };
         float releaseCoeff{ 0.0f };
-        float lastEnv{ 0.0f };
-        float currentEnv{ 0.0f };
+        T lastEnv{ 0.0f };
+        T currentEnv{ 0.0f };
         float sampleRate{ 1.0f };
-        static constexpr int divFreq = 4;
+        int divFreq = 4;
         dsp::ClockDivider divider;
 
         static constexpr float TC{ -0.9996723408f }; // { std::log (0.368f); } //capacitor discharge to 36.8%
     };
 
+    using Compressor = TCompressor<float>;
+
     inline float saturate (float in, float max = 1.0f, float kneeWidth = 0.05)
     {
         auto ret = 0.0f;
@@ -138,13 +154,19 @@ namespace sspo
         return saturate (in, 11.7f, 0.5f);
     }
 
-    inline float_4 voltageSaturate (float_4 in)
+    /// the same curve as saturate (float), for four lanes without branches
+    inline float_4 saturate (float_4 in, float max = 1.0f, float kneeWidth = 0.05f)
     {
-        float_4 ret;
-        for (auto i = 0; i < 4; ++i)
-            ret[i] = voltageSaturate (in[i]);
+        const float_4 level = simd::abs (in);
+        const float_4 over = level - max + kneeWidth * 0.5f;
+        const float_4 knee = level - over * over / (2.0f * kneeWidth);
+        const float_4 ret = simd::ifelse (level < max - kneeWidth, level, simd::ifelse (level < max, knee, float_4 (max)));
+        return simd::ifelse (in < 0.0f, -ret, ret);
+    }
 
-        return ret;
+    inline float_4 voltageSaturate (float_4 in)
+    {
+        return saturate (in, 11.7f, 0.5f);
     }
 
     struct Saturator
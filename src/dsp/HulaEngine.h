@@ -0,0 +1,421 @@
+/*
+ * Copyright (c) 2021 Dave French <contact/dot/dave/dot/french3/at/googlemail/dot/com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include "AudioMath.h"
+#include "LookupTable.h"
+#include "UtilityFilters.h"
+#include "digital.hpp"
+#include "simd/functions.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace sspo
+{
+    /// The Hula oscillator without any ports or params, so it can be run on its own by the perf and fuzz tests.
+    /// Settings are taken once per block with setSettings, then process runs one group of four voices.
+    class HulaEngine
+    {
+    public:
+        using float_4 = rack::simd::float_4;
+
+        static constexpr int maxGroups = 4;
+        static constexpr int maxOperators = 4;
+        static constexpr int maxOversample = 8;
+
+        /// oversampling factor, 1x for modulators and bass where the aliasing protection is wasted
+        enum class Quality
+        {
+            X1,
+            X2,
+            X4,
+            X8,
+            COUNT
+        };
+
+        /// a single phase modulated sine, or an internal 2 or 4 operator FM voice
+        enum class Operators
+        {
+            SINGLE,
+            TWO,
+            FOUR,
+            COUNT
+        };
+
+        /// An FM algorithm, for each operator a bit mask of the operators it modulates,
+        /// and a bit mask of the operators that are heard.
+        /// Operators only modulate lower numbered ones, so they are run from the top down.
+        struct Algorithm
+        {
+            int targets[maxOperators];
+            int carriers;
+        };
+
+        static int algorithmCount (Operators operators)
+        {
+            return operators == Operators::FOUR ? 4 : (operators == Operators::TWO ? 2 : 1);
+        }
+
+        /// 2 op:  2>1, 2+1
+        /// 4 op:  4>3>2>1, 4>3 + 2>1, (2+3+4)>1, 4>(1+2+3)
+        static const Algorithm& getAlgorithm (Operators operators, int index)
+        {
+            static const Algorithm single = { { 0, 0, 0, 0 }, 0x1 };
+            static const Algorithm two[] = { { { 0, 0x1, 0, 0 }, 0x1 },
+                                             { { 0, 0, 0, 0 }, 0x3 } };
+            static const Algorithm four[] = { { { 0, 0x1, 0x2, 0x4 }, 0x1 },
+                                              { { 0, 0x1, 0, 0x4 }, 0x5 },
+                                              { { 0, 0x1, 0x1, 0x1 }, 0x1 },
+                                              { { 0, 0, 0, 0x7 }, 0x7 } };
+            index = std::min (std::max (index, 0), algorithmCount (operators) - 1);
+            if (operators == Operators::FOUR)
+                return four[index];
+            if (operators == Operators::TWO)
+                return two[index];
+            return single;
+        }
+
+        /// the panel and menu values, read once per block
+        struct Settings
+        {
+            /// octaves, with the semitones already added
+            float pitch = 0.0f;
+            float depth = 0.0f;
+            float feedback = 0.0f;
+            Quality quality = Quality::X4;
+            Operators operators = Operators::SINGLE;
+            int algorithm = 0;
+            /// operator 1 is the panel ratio, its level is fixed at 1
+            std::array<float, maxOperators> ratios = { { 1.0f, 1.0f, 1.0f, 1.0f } };
+            std::array<float, maxOperators> levels = { { 1.0f, 0.0f, 0.0f, 0.0f } };
+            bool depthCvConnected = false;
+            bool feedbackCvConnected = false;
+        };
+
+        /// one group of four voices, in volts
+        struct Inputs
+        {
+            float_4 voct = 0.0f;
+            float_4 fm = 0.0f;
+            float_4 depthCv = 0.0f;
+            float_4 feedbackCv = 0.0f;
+        };
+
+        void setSampleRate (float rate)
+        {
+            reciprocalSampleRate = 1 / rate;
+            sampleRate = rate;
+
+            for (auto& l : lpFilters)
+                l.setButterworthLp2 (rate, std::min (10e3f, rate * 0.25f));
+
+            for (auto& dc : dcOutFilters)
+                dc.setCutoff (sampleRate, dcOutCutoff);
+
+            /// filter the changes in depth and feedback by fs/40
+            for (auto& d : depthFilters)
+                d.setButterworthLp2 (1000.0f, 25.0f);
+
+            for (auto& f : feedbackFilters)
+                f.setButterworthLp2 (1000.0f, 25.0f);
+
+            setSettings (settings);
+        }
+
+        // must be called after setSampleRate
+        void init()
+        {
+            // set random detune, += 5 cent;
+            for (auto& f : fineTuneVocts)
+                f = float_4 ((AudioMath::rand01() * 2.0f - 1.0f) * 5.0f / (12.0f * 100.0f),
+                             (AudioMath::rand01() * 2.0f - 1.0f) * 5.0f / (12.0f * 100.0f),
+                             (AudioMath::rand01() * 2.0f - 1.0f) * 5.0f / (12.0f * 100.0f),
+                             (AudioMath::rand01() * 2.0f - 1.0f) * 5.0f / (12.0f * 100.0f));
+
+            for (auto& l : lastOuts)
+                l = float_4 (0);
+
+            for (auto& group : phases)
+            {
+                for (auto& p : group)
+                    p = float_4 (0);
+            }
+
+            for (auto& group : operatorFeedback)
+            {
+                for (auto& f : group)
+                    f = float_4 (0);
+            }
+
+            dither.setSeed (static_cast<uint32_t> (AudioMath::rand01() * 4294967295.0f));
+        }
+
+        void setResampler (const Resampler newResampler)
+        {
+            resampler = newResampler;
+            if (resampler != Resampler::IIR)
+            {
+                const auto phase = resamplerPhase (resampler);
+                for (auto& d : decimators2.fir)
+                    d.setPhase (phase);
+                for (auto& d : decimators4.fir)
+                    d.setPhase (phase);
+                for (auto& d : decimators8.fir)
+                    d.setPhase (phase);
+            }
+        }
+
+        /// everything that only depends on the settings is worked out here, not per group
+        void setSettings (const Settings& newSettings)
+        {
+            settings = newSettings;
+            oversample = 1 << static_cast<int> (settings.quality);
+            incrementScale = rack::dsp::FREQ_C4 * reciprocalSampleRate / oversample;
+
+            operatorCount = settings.operators == Operators::FOUR ? 4 : (settings.operators == Operators::TWO ? 2 : 1);
+            algorithm = &getAlgorithm (settings.operators, settings.algorithm);
+
+            auto carrierSum = 0.0f;
+            for (auto op = 0; op < maxOperators; ++op)
+            {
+                const auto level = op == 0 ? 1.0f : settings.levels[op];
+                modulationLevels[op] = level * modulationScale;
+                carrierLevels[op] = level;
+                if (op < operatorCount && (algorithm->carriers & (1 << op)))
+                    carrierSum += level;
+            }
+            // several carriers are mixed down to the level of one
+            carrierScale = 1.0f / std::max (carrierSum, 1.0f);
+        }
+
+        const Settings& getSettings() const
+        {
+            return settings;
+        }
+
+        /// an operator's phase in cycles, always 0 to 1
+        float_4 getPhase (int group, int op) const
+        {
+            return phases[group][op];
+        }
+
+        /// one sample for the first groups groups of four voices, out is +-5V.
+        /// The quality is switched on once here, so the per group code is specialised on the oversampling factor.
+        void process (const Inputs* in, float_4* out, int groups)
+        {
+            switch (settings.quality)
+            {
+                case Quality::X1:
+                    for (auto group = 0; group < groups; ++group)
+                        out[group] = processGroup<1> (group, in[group], decimators4);
+                    break;
+                case Quality::X2:
+                    for (auto group = 0; group < groups; ++group)
+                        out[group] = processGroup<2> (group, in[group], decimators2);
+                    break;
+                case Quality::X8:
+                    for (auto group = 0; group < groups; ++group)
+                        out[group] = processGroup<8> (group, in[group], decimators8);
+                    break;
+                default:
+                    for (auto group = 0; group < groups; ++group)
+                        out[group] = processGroup<4> (group, in[group], decimators4);
+                    break;
+            }
+        }
+
+    private:
+        static constexpr int oversampleQuality = 1;
+        static constexpr float dcOutCutoff = 5.5f;
+        /// phase offset in cycles per volt of output fed back, and per unit of a modulating operator at full level
+        static constexpr float feedbackScale = 0.053f;
+        static constexpr float modulationScale = 1.0f;
+        /// low level randomness in the sine, was previously baked into a lookup table
+        static constexpr float ditherLevel = 1e-4f;
+
+        /// the IIR and FIR decimators for one oversampling factor
+        template <int factor>
+        struct Decimators
+        {
+            std::array<Decimator<factor, oversampleQuality, float_4>, maxGroups> iir;
+            std::array<FirDecimator<factor, float_4>, maxGroups> fir;
+        };
+
+        /// one group of four voices, the decimators are unused at 1x
+        template <int factor, typename TDecimators>
+        float_4 processGroup (int group, const Inputs& in, TDecimators& decimators)
+        {
+            // the pow2 table covers +-10 octaves and is not range checked
+            float_4 voct = rack::simd::clamp (in.voct + fineTuneVocts[group] + settings.pitch, float_4 (-10.0f), float_4 (10.0f));
+            float_4 noteInc = lookup.pow2 (voct) * incrementScale;
+            float_4 phaseIncs[maxOperators];
+            for (auto op = 0; op < operatorCount; ++op)
+                phaseIncs[op] = noteInc * settings.ratios[op];
+
+            //phase offset as fm is implemented as phase modulation
+            float_4 feedback = settings.feedback;
+            if (settings.feedbackCvConnected)
+                feedback *= feedbackFilters[group].process (rack::simd::abs (in.feedbackCv * 0.1f));
+
+            float_4 fmIn = in.fm * 0.2f; // scale from +-5 to +=1
+            if (settings.depthCvConnected)
+                fmIn *= depthFilters[group].process (rack::simd::abs (in.depthCv * 0.1f));
+
+            float_4 phaseOffset = settings.depth * fmIn;
+
+            float_4 decimated;
+            if (factor == 1)
+            {
+                generate<1> (group, phaseIncs, feedback, phaseOffset);
+                decimated = oversampleBuffers[group][0];
+            }
+            else
+            {
+                decimated = oscillate (group, phaseIncs, feedback, phaseOffset, decimators);
+            }
+
+            lastOuts[group] = dcOutFilters[group].process (decimated) * 5.0f;
+            // without oversampling there is nothing for the smoothing filter to remove
+            return factor == 1 ? lastOuts[group] : lpFilters[group].process (lastOuts[group]);
+        }
+
+        /// run one group of the oscillator at oversample times the sample rate, returns it decimated
+        template <int factor>
+        float_4 oscillate (int group, const float_4* phaseIncs, float_4 feedback, float_4 phaseOffset, Decimators<factor>& decimators)
+        {
+            auto& buffer = oversampleBuffers[group];
+            generate<factor> (group, phaseIncs, feedback, phaseOffset);
+            return resampler == Resampler::IIR
+                       ? decimators.iir[group].process (buffer.data())
+                       : decimators.fir[group].process (buffer.data());
+        }
+
+        template <int count>
+        void generate (int group, const float_4* phaseIncs, float_4 feedback, float_4 phaseOffset)
+        {
+            if (operatorCount == 4)
+            {
+                generateOperators<count, 4> (group, phaseIncs, feedback, phaseOffset);
+                return;
+            }
+            if (operatorCount == 2)
+            {
+                generateOperators<count, 2> (group, phaseIncs, feedback, phaseOffset);
+                return;
+            }
+
+            // the single operator feeds back its decimated output
+            phaseOffset += feedback * feedbackScale * lastOuts[group];
+            auto& phase = phases[group][0];
+            for (auto i = 0; i < count; ++i)
+            {
+                phase += phaseIncs[0];
+                // a step can be many cycles at 1x with high ratios, subtracting one cycle can't keep up
+                phase -= rack::simd::floor (phase);
+                oversampleBuffers[group][i] = AudioMath::fastSin2Pi (phase + phaseOffset) + dither.process() * ditherLevel;
+            }
+        }
+
+        /// the operators of a group run together, each float_4 holding the same operator for four voices
+        template <int count, int operators>
+        void generateOperators (int group, const float_4* phaseIncs, float_4 feedback, float_4 phaseOffset)
+        {
+            const auto top = operators - 1;
+            auto& phase = phases[group];
+            auto& history = operatorFeedback[group];
+            // the top operator's own output, in place of the decimated output the single operator uses
+            feedback *= feedbackScale * 5.0f;
+
+            for (auto i = 0; i < count; ++i)
+            {
+                float_4 modulation[operators];
+                for (auto op = 0; op < operators; ++op)
+                    modulation[op] = 0.0f;
+                float_4 out = 0.0f;
+
+                for (auto op = top; op >= 0; --op)
+                {
+                    phase[op] += phaseIncs[op];
+                    phase[op] -= rack::simd::floor (phase[op]);
+
+                    float_4 offset = modulation[op];
+                    if (op == top)
+                        offset += feedback * 0.5f * (history[0] + history[1]);
+                    if (op == 0)
+                        offset += phaseOffset;
+
+                    float_4 y = AudioMath::fastSin2Pi (phase[op] + offset);
+                    if (op == top)
+                    {
+                        history[1] = history[0];
+                        history[0] = y;
+                    }
+
+                    for (auto target = 0; target < op; ++target)
+                    {
+                        if (algorithm->targets[op] & (1 << target))
+                            modulation[target] += y * modulationLevels[op];
+                    }
+                    if (algorithm->carriers & (1 << op))
+                        out += y * carrierLevels[op];
+                }
+                oversampleBuffers[group][i] = out * carrierScale + dither.process() * ditherLevel;
+            }
+        }
+
+        float reciprocalSampleRate = 1.0f / 44100.0f;
+        float sampleRate = 44100.0f;
+
+        Settings settings;
+        // derived from the settings
+        int oversample = 4;
+        float incrementScale = 1.0f;
+        int operatorCount = 1;
+        const Algorithm* algorithm = &getAlgorithm (Operators::SINGLE, 0);
+        std::array<float, maxOperators> modulationLevels;
+        std::array<float, maxOperators> carrierLevels;
+        float carrierScale = 1.0f;
+
+        std::array<float_4, maxGroups> lastOuts;
+        std::array<float_4, maxGroups> fineTuneVocts;
+        /// operator phases per group, operator 1 is the single operator oscillator
+        std::array<std::array<float_4, maxOperators>, maxGroups> phases;
+        /// last two outputs of the top operator, averaged for its self feedback
+        std::array<std::array<float_4, 2>, maxGroups> operatorFeedback;
+
+        Decimators<2> decimators2;
+        Decimators<4> decimators4;
+        Decimators<8> decimators8;
+        Resampler resampler = Resampler::IIR;
+        std::array<std::array<float_4, maxOversample>, maxGroups> oversampleBuffers;
+        std::array<DcBlocker<float_4>, maxGroups> dcOutFilters;
+        std::array<SOSCascade<float_4, 1>, maxGroups> lpFilters;
+
+        std::array<BiQuad<float_4>, maxGroups> depthFilters;
+        std::array<BiQuad<float_4>, maxGroups> feedbackFilters;
+
+        AudioMath::NoiseSource4 dither;
+    };
+
+} // namespace sspo
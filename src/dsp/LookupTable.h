@@ -20,7 +20,9 @@
  */
 
 #pragma once
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <functional>
 #include <sstream>
 #include <vector>
@@ -149,6 +151,108 @@ namespace sspo
                 return ret;
             }
 
+            /// A function of two variables, such as a saturation curve keyed on input and drive.
+            /// Stored as a row of x values for each y, so a slowly changing y keeps reads within one or two rows.
+            template <typename T>
+            struct Table2D
+            {
+                T minX = 0;
+                T maxX = 0;
+                T intervalX = 0;
+                T minY = 0;
+                T maxY = 0;
+                T intervalY = 0;
+                int sizeX = 0;
+                int sizeY = 0;
+                std::vector<T> table;
+            };
+
+            /// bilinear interpolation, x and y are clamped to the table so the edge values extend past it
+            template <typename T>
+            inline T process (const Table2D<T>& source, T x, T y) noexcept
+            {
+                assert (source.sizeX > 1 && source.sizeY > 1 && "Lookup table empty");
+
+                // written so a NaN fails both compares and reads the low edge, like the vector clamp
+                x = x > source.minX ? (x < source.maxX ? x : source.maxX) : source.minX;
+                y = y > source.minY ? (y < source.maxY ? y : source.maxY) : source.minY;
+                const T positionX = (x - source.minX) / source.intervalX;
+                const T positionY = (y - source.minY) / source.intervalY;
+                const auto indexX = std::min (static_cast<int> (positionX), source.sizeX - 2);
+                const auto indexY = std::min (static_cast<int> (positionY), source.sizeY - 2);
+                const T fractionX = positionX - indexX;
+                const T fractionY = positionY - indexY;
+
+                const auto* row = &source.table[indexY * source.sizeX + indexX];
+                const T lower = linearInterpolate (row[0], row[1], fractionX);
+                const T upper = linearInterpolate (row[source.sizeX], row[source.sizeX + 1], fractionX);
+                return linearInterpolate (lower, upper, fractionY);
+            }
+
+            /// four lanes, the interpolation is vector code and only the four corner reads are per lane
+            template <typename T>
+            inline float_4 process (const Table2D<T>& source, float_4 x, float_4 y)
+            {
+                assert (source.sizeX > 1 && source.sizeY > 1 && "Lookup table empty");
+
+                x = rack::simd::clamp (x, float_4 (source.minX), float_4 (source.maxX));
+                y = rack::simd::clamp (y, float_4 (source.minY), float_4 (source.maxY));
+                const float_4 positionX = (x - source.minX) / source.intervalX;
+                const float_4 positionY = (y - source.minY) / source.intervalY;
+                const float_4 indexX = rack::simd::fmin (rack::simd::floor (positionX), float_4 (source.sizeX - 2));
+                const float_4 indexY = rack::simd::fmin (rack::simd::floor (positionY), float_4 (source.sizeY - 2));
+                const float_4 fractionX = positionX - indexX;
+                const float_4 fractionY = positionY - indexY;
+                const float_4 index = indexY * static_cast<float> (source.sizeX) + indexX;
+
+                float_4 corners[4];
+                for (auto i = 0; i < 4; ++i)
+                {
+                    const auto* row = &source.table[static_cast<int> (index[i])];
+                    corners[0][i] = row[0];
+                    corners[1][i] = row[1];
+                    corners[2][i] = row[source.sizeX];
+                    corners[3][i] = row[source.sizeX + 1];
+                }
+                const float_4 lower = linearInterpolate (corners[0], corners[1], fractionX);
+                const float_4 upper = linearInterpolate (corners[2], corners[3], fractionX);
+                return linearInterpolate (lower, upper, fractionY);
+            }
+
+            /// the 2D version of makeTable, funct (x, y) is sampled from min to max inclusive on both axes
+            template <typename T>
+            inline Table2D<T> makeTable2D (const T minX,
+                                           const T maxX,
+                                           const T intervalX,
+                                           const T minY,
+                                           const T maxY,
+                                           const T intervalY,
+                                           std::function<T (const T x, const T y)> funct)
+            {
+                assert (minX < maxX && minY < maxY);
+                assert (intervalX > 0 && intervalY > 0);
+
+                Table2D<T> ret;
+                ret.minX = minX;
+                ret.maxX = maxX;
+                ret.intervalX = intervalX;
+                ret.minY = minY;
+                ret.maxY = maxY;
+                ret.intervalY = intervalY;
+                // positions are computed from the index, so rounding does not build up along a row
+                ret.sizeX = static_cast<int> (std::ceil ((maxX - minX) / intervalX)) + 1;
+                ret.sizeY = static_cast<int> (std::ceil ((maxY - minY) / intervalY)) + 1;
+
+                ret.table.reserve (ret.sizeX * ret.sizeY);
+                for (auto j = 0; j < ret.sizeY; ++j)
+                {
+                    for (auto i = 0; i < ret.sizeX; ++i)
+                        ret.table.push_back (funct (minX + i * intervalX, minY + j * intervalY));
+                }
+
+                return ret;
+            }
+
             inline std::string makeHeader (Table<float>& data, const std::string name = "NONAMEGIVEN")
             {
                 static constexpr int maxValPerLine = 8;
@@ -219,6 +323,7 @@ namespace sspo
                 float pow10 (const float x) { return sspo::AudioMath::LookupTable::process (pow10Table, x); }
                 float log10 (const float x) { return sspo::AudioMath::LookupTable::process (log10Table, x); }
                 float unisonSpread (const float x) { return sspo::AudioMath::LookupTable::process (unisonSpreadTable, x); }
+                float_4 unisonSpread (const float_4 x) { return sspo::AudioMath::LookupTable::process (unisonSpreadTable, x); }
                 float hulaSin (const float x) { return sspo::AudioMath::LookupTable::process (hulaSineTable, x); }
                 float_4 hulaSin4 (const float_4 x) { return sspo::AudioMath::LookupTable::process (hulaSineTable, x); }
             };
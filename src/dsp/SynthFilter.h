@@ -221,10 +221,7 @@ namespace sspo
             SynthFilter<T>::Q = newQ;
             SynthFilter<T>::sampleRate = newSampleRate;
             SynthFilter<T>::saturation = newSaturation;
-            lpf1.setParameters (SynthFilter<T>::cutoff, 0, 0, SynthFilter<T>::sampleRate);
-            lpf2.setParameters (SynthFilter<T>::cutoff, 0, 0, SynthFilter<T>::sampleRate);
-            lpf3.setParameters (SynthFilter<T>::cutoff, 0, 0, SynthFilter<T>::sampleRate);
-            lpf4.setParameters (SynthFilter<T>::cutoff, 0, 0, SynthFilter<T>::sampleRate);
+            // the one poles' coefficients all come from calcCoeffs, setting their cutoff would only add four tan()
 
             K = (4.0f) * (SynthFilter<T>::Q - 1.0f) / (10.0f - 1.0f);
             calcCoeffs();
@@ -249,7 +246,14 @@ namespace sspo
 
             if (SynthFilter<T>::useNPL)
             {
-                if (SynthFilter<T>::useOverSample)
+                if (SynthFilter<T>::useOverSample && resampler != sspo::Resampler::IIR)
+                {
+                    firUpsampler.process (U, oversampleBuffer);
+                    for (auto i = 0; i < oversampleRate; ++i)
+                        oversampleBuffer[i] = nonLinearProcess (oversampleBuffer[i], SynthFilter<T>::saturation);
+                    U = firDecimator.process (oversampleBuffer);
+                }
+                else if (SynthFilter<T>::useOverSample)
                 {
                     upsampler.process (U, oversampleBuffer);
                     for (auto i = 0; i < oversampleRate; ++i)
@@ -280,6 +284,19 @@ namespace sspo
             calcCoeffs();
         }
 
+        /// oversampling filters for the non linear stage
+        /// this is inside the feedback loop, so the FIR latency lowers the resonant frequency,
+        /// the minimum phase design keeps it short
+        void setResampler (const sspo::Resampler newResampler)
+        {
+            resampler = newResampler;
+            if (resampler != sspo::Resampler::IIR)
+            {
+                firUpsampler.setPhase (sspo::resamplerPhase (resampler));
+                firDecimator.setPhase (sspo::resamplerPhase (resampler));
+            }
+        }
+
         void reset()
         {
             lpf1.reset();
@@ -371,6 +388,9 @@ namespace sspo
         static constexpr int oversampleRate = 4;
         sspo::Upsampler<oversampleRate, 1, T> upsampler;
         sspo::Decimator<oversampleRate, 1, T> decimator;
+        sspo::FirUpsampler<oversampleRate, T> firUpsampler;
+        sspo::FirDecimator<oversampleRate, T> firDecimator;
+        sspo::Resampler resampler = sspo::Resampler::IIR;
         T oversampleBuffer[oversampleRate];
     };
 } // namespace sspo
\ No newline at end of file
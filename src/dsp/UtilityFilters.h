@@ -27,6 +27,12 @@
 #include "simd/sse_mathfun_extension.h"
 #include "simd/sse_mathfun.h"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <complex>
+#include <vector>
+
 using float_4 = rack::simd::float_4;
 
 using namespace sspo::AudioMath;
@@ -186,6 +192,107 @@ namespace sspo
         }
     };
 
+    /// Cascade of N second order sections
+    /// transposed direct form II, two states per section
+    /// coefficients are stored contiguously, the wet/dry c0, d0 stage
+    /// of BiQuad is only applied when enabled with setWetDry
+    template <typename T, int N>
+    struct SOSCascade
+    {
+        using Section = typename BiQuad<T>::BiquadCoeffecients;
+
+        SOSCascade()
+        {
+            // pass through until coefficients are set
+            for (auto i = 0; i < N; ++i)
+                setSection (i, T (1.0f), T (0.0f), T (0.0f), T (0.0f), T (0.0f));
+            clear();
+        }
+
+        void clear()
+        {
+            for (auto i = 0; i < N; ++i)
+            {
+                z1[i] = T (0.0f);
+                z2[i] = T (0.0f);
+            }
+        }
+
+        void setSection (const int i, const T a0, const T a1, const T a2, const T b1, const T b2)
+        {
+            sections[i].a0 = a0;
+            sections[i].a1 = a1;
+            sections[i].a2 = a2;
+            sections[i].b1 = b1;
+            sections[i].b2 = b2;
+        }
+
+        /// copy the coefficients from a BiQuad, its c0 and d0 are ignored
+        void setSection (const int i, const BiQuad<T>& design)
+        {
+            setSection (i, design.coeffs.a0, design.coeffs.a1, design.coeffs.a2, design.coeffs.b1, design.coeffs.b2);
+        }
+
+        /// set every section to the same coefficients
+        void setAllSections (const BiQuad<T>& design)
+        {
+            for (auto i = 0; i < N; ++i)
+                setSection (i, design);
+        }
+
+        void setWetDry (const T c0, const T d0)
+        {
+            wet = c0;
+            dry = d0;
+            useWetDry = true;
+        }
+
+        void clearWetDry()
+        {
+            wet = T (1.0f);
+            dry = T (0.0f);
+            useWetDry = false;
+        }
+
+        void setButterworthLp2 (const T sr, const T freq)
+        {
+            BiQuad<T> design;
+            design.setButterworthLp2 (sr, freq);
+            setAllSections (design);
+        }
+
+        void setButterworthHp2 (const T sr, const T freq)
+        {
+            BiQuad<T> design;
+            design.setButterworthHp2 (sr, freq);
+            setAllSections (design);
+        }
+
+        T process (const T in)
+        {
+            T x = in;
+            for (auto i = 0; i < N; ++i)
+            {
+                const auto& s = sections[i];
+                T y = s.a0 * x + z1[i];
+                z1[i] = s.a1 * x - s.b1 * y + z2[i];
+                z2[i] = s.a2 * x - s.b2 * y;
+                x = y;
+            }
+            return useWetDry ? x * wet + in * dry : x;
+        }
+
+        std::array<Section, N> sections;
+
+    private:
+        //memory
+        std::array<T, N> z1;
+        std::array<T, N> z2;
+        T wet{ 1.0f };
+        T dry{ 0.0f };
+        bool useWetDry{ false };
+    };
+
     template <typename T>
     struct LinkwitzRileyLP2
     {
@@ -233,53 +340,219 @@ namespace sspo
     template <typename T>
     struct LinkwitzRileyLP4
     {
-        BiQuad<T> f1;
-        BiQuad<T> f2;
+        SOSCascade<T, 2> filter;
 
         LinkwitzRileyLP4()
         {
-            f1.clear();
-            f2.clear();
+            filter.clear();
         }
 
         void setParameters (const T sr, const T fc)
         {
-            f1.setButterworthLp2 (sr, fc);
-            f2.setButterworthLp2 (sr, fc);
+            filter.setButterworthLp2 (sr, fc);
         }
 
         T process (const T in)
         {
-            T out = f1.process (in);
-            out = f2.process (out);
-            return out;
+            return filter.process (in);
         }
     };
 
     template <typename T>
     struct LinkwitzRileyHP4
     {
-        BiQuad<T> f1;
-        BiQuad<T> f2;
+        SOSCascade<T, 2> filter;
 
         LinkwitzRileyHP4()
         {
-            f1.clear();
-            f2.clear();
+            filter.clear();
         }
 
         void setParameters (const T sr, const T fc)
         {
-            f1.setButterworthHp2 (sr, fc);
-            f2.setButterworthHp2 (sr, fc);
+            filter.setButterworthHp2 (sr, fc);
         }
 
         T process (const T in)
         {
-            T out = f1.process (in);
-            out = f2.process (out);
+            return filter.process (in);
+        }
+    };
+
+    /// First order DC blocker, one state and one multiply add per lane
+    /// The state is a leaky integrator tracking the dc, the output is the input less the state.
+    template <typename T>
+    struct DcBlocker
+    {
+        void setCutoff (const float sr, const float fc)
+        {
+            g = 1.0f - std::exp (-AudioMath::k_2pi * fc / sr);
+        }
+
+        void clear()
+        {
+            state = T (0.0f);
+        }
+
+        T process (const T in)
+        {
+            T out = in - state;
+            state += g * out;
             return out;
         }
+
+    private:
+        float g = 0.0f;
+        T state{ 0.0f };
+    };
+
+    /// Linkwitz-Riley 4th order crossover, low and high band from one structure
+    /// The LP4 and HP4 share their poles, so both bands are derived from
+    /// Butterworth state variable sections (Zavalishin TPT) that share one set
+    /// of coefficients. The first section gives the 2nd order low and high pass
+    /// together, each is then passed through a second section.
+    /// Coefficients are only recalculated when the frequency or sample rate changes.
+    template <typename T>
+    struct LinkwitzRileyCrossover
+    {
+        LinkwitzRileyCrossover()
+        {
+            clear();
+        }
+
+        void clear()
+        {
+            for (auto& s : states)
+                s = T (0.0f);
+        }
+
+        void setParameters (const T sr, const T freq)
+        {
+            if (! hasChanged (freq, lastFreq) && ! hasChanged (sr, lastSr))
+                return;
+
+            lastFreq = freq;
+            lastSr = sr;
+            T fc = rack::simd::ifelse (freq < sr * 0.5f, freq, freq * 0.95f);
+            g = rack::simd::tan (k_pi * fc / sr);
+            gk = g + k;
+            d = 1.0f / (1.0f + k * g + g * g);
+        }
+
+        void process (const T in, T& low, T& high)
+        {
+            T lp1;
+            T hp1;
+            section (in, states[0], states[1], lp1, hp1);
+
+            T unused;
+            section (lp1, states[2], states[3], low, unused);
+            section (hp1, states[4], states[5], unused, high);
+        }
+
+        /// The sum of the low and high bands, a 2nd order allpass sharing the crossover poles.
+        /// Uses only the first section, an instance should be used for either process or allpass, not both
+        T allpass (const T in)
+        {
+            T lp;
+            T hp;
+            section (in, states[0], states[1], lp, hp);
+            // in = lp + k * bp + hp, allpass = in - 2 * k * bp
+            return 2.0f * (lp + hp) - in;
+        }
+
+        T g{ 0.0f };
+        T gk{ 0.0f };
+        T d{ 0.0f };
+
+    private:
+        inline void section (const T in, T& s1, T& s2, T& lp, T& hp)
+        {
+            hp = (in - gk * s1 - s2) * d;
+            auto v1 = g * hp;
+            auto bp = v1 + s1;
+            s1 = bp + v1;
+            auto v2 = g * bp;
+            lp = v2 + s2;
+            s2 = lp + v2;
+        }
+
+        // 1/Q for Butterworth
+        static constexpr float k = 1.414213562f;
+        T lastFreq{ -1.0f };
+        T lastSr{ -1.0f };
+        std::array<T, 6> states;
+    };
+
+    /// Linkwitz-Riley 3 or 4 band crossover, a tree of LR4 splits
+    /// Each branch of the tree is passed through the allpass of the splits in the other branch,
+    /// so all bands share the same phase response and sum flat.
+    /// 4 bands, split at mid, the low branch is compensated for high, the high branch for low.
+    /// 3 bands, split at high, the high band is compensated for low.
+    template <typename T>
+    struct LinkwitzRileyMultiband
+    {
+        static constexpr int maxBands = 4;
+
+        void setBands (const int b)
+        {
+            assert (b == 3 || b == maxBands);
+            if (b != bands)
+                clear();
+            bands = b;
+        }
+
+        int getBands() const
+        {
+            return bands;
+        }
+
+        void clear()
+        {
+            lowSplit.clear();
+            midSplit.clear();
+            highSplit.clear();
+            lowAllpass.clear();
+            highAllpass.clear();
+        }
+
+        /// midFreq is ignored in 3 band mode
+        void setParameters (const T sr, const T lowFreq, const T midFreq, const T highFreq)
+        {
+            lowSplit.setParameters (sr, lowFreq);
+            highSplit.setParameters (sr, highFreq);
+            lowAllpass.setParameters (sr, lowFreq);
+            if (bands == 3)
+                return;
+            midSplit.setParameters (sr, midFreq);
+            highAllpass.setParameters (sr, highFreq);
+        }
+
+        /// out low to high, out[3] is untouched in 3 band mode
+        void process (const T in, std::array<T, maxBands>& out)
+        {
+            T low;
+            T high;
+            if (bands == 3)
+            {
+                highSplit.process (in, low, high);
+                lowSplit.process (low, out[0], out[1]);
+                out[2] = lowAllpass.allpass (high);
+                return;
+            }
+
+            midSplit.process (in, low, high);
+            lowSplit.process (highAllpass.allpass (low), out[0], out[1]);
+            highSplit.process (lowAllpass.allpass (high), out[2], out[3]);
+        }
+
+    private:
+        int bands = maxBands;
+        LinkwitzRileyCrossover<T> lowSplit;
+        LinkwitzRileyCrossover<T> midSplit;
+        LinkwitzRileyCrossover<T> highSplit;
+        LinkwitzRileyCrossover<T> lowAllpass;
+        LinkwitzRileyCrossover<T> highAllpass;
     };
 
     /// IIR Decimator
@@ -288,29 +561,21 @@ namespace sspo
     template <int oversample, int quality, typename T>
     struct Decimator
     {
-        BiQuad<T> filters[quality];
+        SOSCascade<T, quality> filters;
 
         Decimator()
         {
-            for (auto i = 0; i < quality; ++i)
-            {
-                // the oversample filter has been set at niquist, to remove unwanted
-                // noise in the audio spectrum
-                filters[i].setButterworthLp2 (10000.0f, 10000.0f / (1.0f * oversample));
-            }
+            // the oversample filter has been set at niquist, to remove unwanted
+            // noise in the audio spectrum
+            filters.setButterworthLp2 (10000.0f, 10000.0f / (1.0f * oversample));
         }
 
         T process (const T* input)
         {
             T x = 0;
             for (auto i = 0; i < oversample; ++i)
-            {
-                x = filters[0].process (input[i]);
-                for (auto j = 1; j < quality; ++j)
-                {
-                    x = filters[j].process (x);
-                }
-            }
+                x = filters.process (input[i]);
+
             // we simply return the last sample
             return x;
         }
@@ -322,16 +587,13 @@ namespace sspo
     template <int oversample, int quality, typename T>
     struct Upsampler
     {
-        BiQuad<T> filters[quality];
+        SOSCascade<T, quality> filters;
 
         Upsampler()
         {
-            for (auto i = 0; i < quality; ++i)
-            {
-                // the oversample filter has been set at niquist, to remove unwanted
-                // noise in the audio spectrum
-                filters[i].setButterworthLp2 (10000.0f, 10000.0f / (1.0f * oversample));
-            }
+            // the oversample filter has been set at niquist, to remove unwanted
+            // noise in the audio spectrum
+            filters.setButterworthLp2 (10000.0f, 10000.0f / (1.0f * oversample));
         }
 
         void process (T in, T* buffer)
@@ -343,12 +605,309 @@ namespace sspo
 
         T doFilter (T in)
         {
-            T x = filters[0].process (in);
-            for (auto i = 1; i < quality; ++i)
+            return filters.process (in);
+        }
+    };
+    /// Half band FIR, split into the two polyphase branches used by the resamplers
+    /// Kaiser windowed sinc, 4 * halfLength - 1 taps. In the linear phase design every other
+    /// tap is zero, so one branch collapses to a single delayed tap.
+    /// The minimum phase design is derived from the linear phase one with the cepstrum,
+    /// it has the same magnitude response but less latency, and no zero taps.
+    struct HalfBandDesign
+    {
+        enum class Phase
+        {
+            LINEAR,
+            MINIMUM
+        };
+
+        // taps of each branch, after the leading zeros that are stored as a delay
+        std::array<std::vector<float>, 2> taps;
+        std::array<int, 2> delays{ { 0, 0 } };
+
+        HalfBandDesign (const int halfLength, const Phase phase)
+        {
+            auto h = linearPhase (halfLength);
+            if (phase == Phase::MINIMUM)
+                h = minimumPhase (h);
+
+            for (auto branch = 0; branch < 2; ++branch)
             {
-                x = filters[i].process (x);
+                std::vector<double> b;
+                for (auto i = branch; i < static_cast<int> (h.size()); i += 2)
+                    b.push_back (h[i]);
+                while (b.size() > 1 && b.back() == 0.0)
+                    b.pop_back();
+                auto first = std::find_if (b.begin(), b.end(), [] (double x) { return x != 0.0; });
+                delays[branch] = static_cast<int> (std::distance (b.begin(), first));
+                taps[branch].assign (first, b.end());
             }
-            return x;
         }
+
+    private:
+        static double besselI0 (const double x)
+        {
+            double sum = 1.0;
+            double term = 1.0;
+            for (auto k = 1; k < 32; ++k)
+            {
+                term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum += term;
+            }
+            return sum;
+        }
+
+        static std::vector<double> linearPhase (const int halfLength)
+        {
+            const int length = 4 * halfLength - 1;
+            const int centre = (length - 1) / 2;
+            // Kaiser window, about 80dB stop band
+            const double beta = 8.0;
+            std::vector<double> h (length, 0.0);
+            double sum = 0.0;
+            for (auto n = 0; n < length; ++n)
+            {
+                auto offset = n - centre;
+                if (offset == 0)
+                    h[n] = 0.5;
+                else if (offset % 2 != 0)
+                {
+                    auto x = AudioMath::LD_PI * offset * 0.5;
+                    auto r = 2.0 * offset / (length - 1);
+                    h[n] = 0.5 * std::sin (x) / x * besselI0 (beta * std::sqrt (1.0 - r * r)) / besselI0 (beta);
+                }
+                sum += h[n];
+            }
+            // unity gain at dc
+            for (auto& x : h)
+                x /= sum;
+            return h;
+        }
+
+        using Complex = std::complex<double>;
+
+        static std::vector<double> minimumPhase (const std::vector<double>& h)
+        {
+            constexpr size_t fftSize = 4096;
+            std::vector<Complex> x (fftSize);
+            std::copy (h.begin(), h.end(), x.begin());
+            AudioMath::fft (x, false);
+
+            // real cepstrum, with the stop band floored at -200dB
+            for (auto& v : x)
+                v = std::log (std::max (std::abs (v), 1.0e-10));
+            AudioMath::fft (x, true);
+
+            // fold the cepstrum onto the causal side
+            for (size_t i = 1; i < fftSize / 2; ++i)
+            {
+                x[i] *= 2.0 / fftSize;
+                x[fftSize - i] = 0.0;
+            }
+            x[0] /= static_cast<double> (fftSize);
+            x[fftSize / 2] /= static_cast<double> (fftSize);
+
+            AudioMath::fft (x, false);
+            for (auto& v : x)
+                v = std::exp (v);
+            AudioMath::fft (x, true);
+
+            std::vector<double> ret (h.size());
+            for (size_t i = 0; i < ret.size(); ++i)
+                ret[i] = x[i].real() / fftSize;
+            return ret;
+        }
+    };
+
+    /// one polyphase branch, an FIR that skips its leading zero taps
+    /// the history is stored twice so the taps always read a contiguous block
+    template <typename T>
+    struct PolyphaseBranch
+    {
+        void setTaps (const std::vector<float>& newTaps, const int newDelay)
+        {
+            taps = newTaps;
+            delay = newDelay;
+            length = delay + static_cast<int> (taps.size());
+            history.assign (2 * length, T (0.0f));
+            pos = 0;
+        }
+
+        void clear()
+        {
+            std::fill (history.begin(), history.end(), T (0.0f));
+        }
+
+        T process (const T in)
+        {
+            pos = pos == 0 ? length - 1 : pos - 1;
+            history[pos] = in;
+            history[pos + length] = in;
+
+            const T* x = &history[pos + delay];
+            T y = 0.0f;
+            for (size_t k = 0; k < taps.size(); ++k)
+                y += taps[k] * x[k];
+            return y;
+        }
+
+    private:
+        std::vector<float> taps;
+        std::vector<T> history;
+        int delay = 0;
+        int length = 0;
+        int pos = 0;
+    };
+
+    /// 2x polyphase half band decimator, only the kept output is computed
+    template <typename T>
+    struct HalfBandDecimator
+    {
+        void setDesign (const HalfBandDesign& design)
+        {
+            even.setTaps (design.taps[0], design.delays[0]);
+            odd.setTaps (design.taps[1], design.delays[1]);
+        }
+
+        void clear()
+        {
+            even.clear();
+            odd.clear();
+        }
+
+        /// two input samples, oldest first
+        T process (const T in0, const T in1)
+        {
+            return even.process (in1) + odd.process (in0);
+        }
+
+    private:
+        PolyphaseBranch<T> even;
+        PolyphaseBranch<T> odd;
+    };
+
+    /// 2x polyphase half band interpolator, each output comes from one branch, no zero stuffing
+    template <typename T>
+    struct HalfBandInterpolator
+    {
+        void setDesign (const HalfBandDesign& design)
+        {
+            even.setTaps (design.taps[0], design.delays[0]);
+            odd.setTaps (design.taps[1], design.delays[1]);
+        }
+
+        void clear()
+        {
+            even.clear();
+            odd.clear();
+        }
+
+        void process (const T in, T& out0, T& out1)
+        {
+            out0 = 2.0f * even.process (in);
+            out1 = 2.0f * odd.process (in);
+        }
+
+    private:
+        PolyphaseBranch<T> even;
+        PolyphaseBranch<T> odd;
+    };
+
+    /// oversampling filters selectable by the modules, the IIR Butterworth chains
+    /// or the polyphase half band FIR cascades
+    enum class Resampler
+    {
+        IIR,
+        FIR_LINEAR,
+        FIR_MINIMUM
+    };
+
+    inline HalfBandDesign::Phase resamplerPhase (const Resampler resampler)
+    {
+        return resampler == Resampler::FIR_MINIMUM ? HalfBandDesign::Phase::MINIMUM : HalfBandDesign::Phase::LINEAR;
+    }
+
+    /// half band lengths for the cascaded resamplers, the stage nearest the base rate has the
+    /// narrowest transition band, the higher rate stages only protect the audio band
+    static constexpr int firBaseStageHalfLength = 12;
+    static constexpr int firHighStageHalfLength = 8;
+
+    /// FIR Decimator, cascaded polyphase half band stages
+    /// oversample, 2, 4 or 8
+    template <int oversample, typename T>
+    struct FirDecimator
+    {
+        static_assert (oversample == 2 || oversample == 4 || oversample == 8, "oversample must be 2, 4 or 8");
+        static constexpr int stageCount = oversample == 2 ? 1 : (oversample == 4 ? 2 : 3);
+
+        FirDecimator (const HalfBandDesign::Phase phase = HalfBandDesign::Phase::LINEAR)
+        {
+            setPhase (phase);
+        }
+
+        void setPhase (const HalfBandDesign::Phase phase)
+        {
+            HalfBandDesign base (firBaseStageHalfLength, phase);
+            HalfBandDesign high (firHighStageHalfLength, phase);
+            for (auto i = 0; i < stageCount; ++i)
+                stages[i].setDesign (i == stageCount - 1 ? base : high);
+        }
+
+        T process (const T* input)
+        {
+            T buffer[oversample / 2];
+            for (auto i = 0; i < oversample / 2; ++i)
+                buffer[i] = stages[0].process (input[2 * i], input[2 * i + 1]);
+
+            auto stage = 1;
+            for (auto n = oversample / 2; n > 1; n /= 2, ++stage)
+            {
+                for (auto i = 0; i < n / 2; ++i)
+                    buffer[i] = stages[stage].process (buffer[2 * i], buffer[2 * i + 1]);
+            }
+            return buffer[0];
+        }
+
+    private:
+        std::array<HalfBandDecimator<T>, stageCount> stages;
+    };
+
+    /// FIR upsample interpolator, cascaded polyphase half band stages
+    /// oversample, 2, 4 or 8
+    template <int oversample, typename T>
+    struct FirUpsampler
+    {
+        static_assert (oversample == 2 || oversample == 4 || oversample == 8, "oversample must be 2, 4 or 8");
+        static constexpr int stageCount = oversample == 2 ? 1 : (oversample == 4 ? 2 : 3);
+
+        FirUpsampler (const HalfBandDesign::Phase phase = HalfBandDesign::Phase::LINEAR)
+        {
+            setPhase (phase);
+        }
+
+        void setPhase (const HalfBandDesign::Phase phase)
+        {
+            HalfBandDesign base (firBaseStageHalfLength, phase);
+            HalfBandDesign high (firHighStageHalfLength, phase);
+            for (auto i = 0; i < stageCount; ++i)
+                stages[i].setDesign (i == 0 ? base : high);
+        }
+
+        void process (const T in, T* buffer)
+        {
+            T previous[oversample / 2];
+            stages[0].process (in, buffer[0], buffer[1]);
+            auto stage = 1;
+            for (auto n = 2; n < oversample; n *= 2, ++stage)
+            {
+                // each stage must see its input in time order
+                std::copy (buffer, buffer + n, previous);
+                for (auto i = 0; i < n; ++i)
+                    stages[stage].process (previous[i], buffer[2 * i], buffer[2 * i + 1]);
+            }
+        }
+
+    private:
+        std::array<HalfBandInterpolator<T>, stageCount> stages;
     };
 } // namespace sspo
\ No newline at end of file
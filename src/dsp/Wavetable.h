@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2020 Dave French <contact/dot/dave/dot/french3/at/googlemail/dot/com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#pragma once
+
+#include "AudioMath.h"
+#include "LookupTable.h"
+#include "simd/functions.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <functional>
+#include <vector>
+
+namespace sspo
+{
+    /// A single cycle waveform held as band limited mip levels, one per octave.
+    /// Level m keeps the harmonics up to tableSize / 2^(m + 1), so level 0 is the full table and the last is a sine.
+    /// The levels are the rows of a Table2D keyed on (phase, level), so one bilinear lookup
+    /// interpolates along the cycle and crossfades between the two nearest levels.
+    class MipmappedWavetable
+    {
+    public:
+        using float_4 = rack::simd::float_4;
+
+        static constexpr int tableSize = 2048;
+        static constexpr int levelCount = 11;
+        /// a row of the table, one cycle and the repeated first point
+        static constexpr int rowSize = tableSize + 1;
+
+        /// one cycle of tableSize samples, each level is built from its FFT with the upper harmonics removed
+        void setCycle (const std::vector<float>& cycle)
+        {
+            assert (static_cast<int> (cycle.size()) == tableSize);
+            std::vector<std::complex<double>> spectrum (cycle.begin(), cycle.end());
+            AudioMath::fft (spectrum, false);
+
+            std::vector<std::vector<float>> levels (levelCount, std::vector<float> (tableSize));
+            std::vector<std::complex<double>> x (tableSize);
+            for (auto level = 0; level < levelCount; ++level)
+            {
+                const auto maxHarmonic = tableSize >> (level + 1);
+                std::fill (x.begin(), x.end(), 0.0);
+                x[0] = spectrum[0];
+                for (auto h = 1; h <= maxHarmonic; ++h)
+                {
+                    x[h] = spectrum[h];
+                    x[tableSize - h] = spectrum[tableSize - h];
+                }
+                AudioMath::fft (x, true);
+                for (auto i = 0; i < tableSize; ++i)
+                    levels[level][i] = static_cast<float> (x[i].real() / tableSize);
+            }
+
+            // the extra point at the end of each row is the start of the cycle, so a read never wraps
+            table = AudioMath::LookupTable::makeTable2D<float> (0.0f,
+                                                     1.0f,
+                                                     1.0f / tableSize,
+                                                     0.0f,
+                                                     static_cast<float> (levelCount - 1),
+                                                     1.0f,
+                                                     [&levels] (const float phase, const float level) {
+                                                         const auto i = static_cast<int> (std::lround (phase * tableSize)) % tableSize;
+                                                         return levels[static_cast<int> (std::lround (level))][i];
+                                                     });
+
+            // a read starts at most on the last cycle point of the row below the top one
+            packed.resize (table.table.size() - rowSize - 1);
+            for (auto i = 0u; i < packed.size(); ++i)
+            {
+                const auto* point = &table.table[i];
+                packed[i] = float_4 (point[0], point[1], point[rowSize], point[rowSize + 1]);
+            }
+        }
+
+        /// funct is one cycle for phase 0 to 1
+        void setFunction (std::function<float (float phase)> funct)
+        {
+            std::vector<float> cycle (tableSize);
+            for (auto i = 0; i < tableSize; ++i)
+                cycle[i] = funct (static_cast<float> (i) / tableSize);
+            setCycle (cycle);
+        }
+
+        /// The fractional level for a phase increment in cycles per sample.
+        /// Level m is alias free while its top harmonic tableSize / 2^(m + 1) is below 0.5 / increment,
+        /// the two levels either side of the result both meet that.
+        static float_4 mipLevel (float_4 increment)
+        {
+            const float_4 harmonicsAbove = rack::simd::log2 (rack::simd::fmax (rack::simd::abs (increment) * tableSize, float_4 (1e-6f)));
+            return rack::simd::clamp (harmonicsAbove + 1.0f, float_4 (0.0f), float_4 (levelCount - 1));
+        }
+
+        /// phase in cycles from 0 to 1, level from mipLevel()
+        float_4 process (float_4 phase, float_4 level) const
+        {
+            const float_4 lowerLevel = rack::simd::fmin (rack::simd::floor (level), float_4 (levelCount - 2));
+            return read (phase, lowerLevel * rowSize, level - lowerLevel);
+        }
+
+        /// The same lookup as the Table2D one, without the clamps and divisions.
+        /// rowStart is the first point of the lower level's row, crossfade moves towards the next level up.
+        float_4 read (float_4 phase, float_4 rowStart, float_4 crossfade) const
+        {
+            const float_4 position = phase * static_cast<float> (tableSize);
+            const float_4 index = rack::simd::fmin (rack::simd::floor (position), float_4 (tableSize - 1));
+            const float_4 fraction = position - index;
+            const rack::simd::int32_4 start = rowStart + index;
+
+            // each packed point holds the four corners, so a lane is one load and the transpose sorts them into corners
+            float_4 corners[4];
+            for (auto i = 0; i < 4; ++i)
+                corners[i] = packed[start[i]];
+            _MM_TRANSPOSE4_PS (corners[0].v, corners[1].v, corners[2].v, corners[3].v);
+            const float_4 lower = AudioMath::linearInterpolate (corners[0], corners[1], fraction);
+            const float_4 upper = AudioMath::linearInterpolate (corners[2], corners[3], fraction);
+            return AudioMath::linearInterpolate (lower, upper, crossfade);
+        }
+
+        bool isEmpty() const
+        {
+            return packed.empty();
+        }
+
+    private:
+        AudioMath::LookupTable::Table2D<float> table;
+        /// the corners for read(), from point i and i + 1 of a row and the same two on the row above
+        std::vector<float_4> packed;
+    };
+
+    /// Four voices reading a shared MipmappedWavetable, one float_4 lane each.
+    /// The mip level follows the frequency, so the output stays band limited without oversampling.
+    class WavetableOscillator
+    {
+    public:
+        using float_4 = rack::simd::float_4;
+
+        void setWavetable (const MipmappedWavetable* newWavetable)
+        {
+            wavetable = newWavetable;
+        }
+
+        /// frequency in Hz, negative runs the cycle backwards
+        void setFrequency (const float_4 frequency, const float sampleTime)
+        {
+            increment = frequency * sampleTime;
+            const float_4 level = MipmappedWavetable::mipLevel (increment);
+            const float_4 lowerLevel = rack::simd::fmin (rack::simd::floor (level), float_4 (MipmappedWavetable::levelCount - 2));
+            rowStart = lowerLevel * MipmappedWavetable::rowSize;
+            crossfade = level - lowerLevel;
+        }
+
+        void reset (const float_4 newPhase = 0.0f)
+        {
+            phase = newPhase;
+        }
+
+        float_4 process()
+        {
+            assert (wavetable != nullptr && ! wavetable->isEmpty());
+            const float_4 out = wavetable->read (phase, rowStart, crossfade);
+            phase += increment;
+            phase -= rack::simd::floor (phase);
+            return out;
+        }
+
+    private:
+        const MipmappedWavetable* wavetable = nullptr;
+        float_4 phase = 0.0f;
+        float_4 increment = 0.0f;
+        /// the mip levels only change with the frequency, so are worked out in setFrequency
+        float_4 rowStart = 0.0f;
+        float_4 crossfade = 0.0f;
+    };
+
+} // namespace sspo
@@ -23,6 +23,7 @@
 #include "Amburgh.h"
 #include "WidgetComposite.h"
 #include "ctrl/SqMenuItem.h"
+#include "ctrl/QualityMenu.h"
 #include "widgets.h"
 
 using Comp = AmburghComp<WidgetComposite>;
@@ -88,6 +89,32 @@ struct AmburghWidget : ModuleWidget
 
         addOutput (createOutputCentered<sspo::PJ301MPort> (mm2px (Vec (41.01, 112.625)), module, Comp::MAIN_OUTPUT));
     }
+
+    void appendContextMenu (Menu* menu) override
+    {
+        auto* module = dynamic_cast<Amburgh*> (this->module);
+        if (module == nullptr)
+            return;
+
+        menu->addChild (new MenuEntry);
+        MenuLabel* controlRateLabel = new MenuLabel();
+        controlRateLabel->text = "Control rate";
+        menu->addChild (controlRateLabel);
+
+        const float divisions[] = { 0.0f, 1.0f, 4.0f, 16.0f, 32.0f };
+        const char* divisionNames[] = { "From quality, 16, 4 or 1", "Every sample (audio rate FM)", "Every 4 samples", "Every 16 samples", "Every 32 samples" };
+        for (auto i = 0; i < 5; ++i)
+        {
+            const auto division = divisions[i];
+            auto* controlRateMenuItem = new SqMenuItem (
+                [module, division]() { return module->params[Comp::CONTROL_RATE_PARAM].getValue() == division; },
+                [module, division]() { module->params[Comp::CONTROL_RATE_PARAM].setValue (division); });
+            controlRateMenuItem->text = divisionNames[i];
+            menu->addChild (controlRateMenuItem);
+        }
+
+        sspo::appendQualityMenu (menu, module, Comp::QUALITY_OVERRIDE_PARAM);
+    }
 };
 
 Model* modelAmburgh = createModel<Amburgh, AmburghWidget> ("Amburgh");
\ No newline at end of file
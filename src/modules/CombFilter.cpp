@@ -23,6 +23,8 @@
 #include "CombFilter.h"
 #include "WidgetComposite.h"
 #include "ctrl/SqHelper.h"
+#include "ctrl/SqMenuItem.h"
+#include "ctrl/QualityMenu.h"
 #include "widgets.h"
 
 using Comp = CombFilterComp<WidgetComposite>;
@@ -86,6 +88,71 @@ struct CombFilterWidget : ModuleWidget
         addInput (createInputCentered<sspo::PJ301MPort> (mm2px (Vec (9.26, 112.625)), module, Comp::MAIN_INPUT));
 
         addOutput (createOutputCentered<sspo::PJ301MPort> (mm2px (Vec (41.01, 112.625)), module, Comp::MAIN_OUTPUT));
+        addOutput (createOutputCentered<sspo::PJ301MPort> (mm2px (Vec (25.135, 112.625)), module, Comp::QUADRATURE_OUTPUT));
+    }
+
+    void appendContextMenu (Menu* menu) override
+    {
+        auto* module = dynamic_cast<CombFilter*> (this->module);
+        if (module == nullptr)
+            return;
+
+        menu->addChild (new MenuEntry);
+        MenuLabel* modeLabel = new MenuLabel();
+        modeLabel->text = "Mode";
+        menu->addChild (modeLabel);
+
+        const char* modeNames[] = { "Comb", "Modulated delay (chorus/flanger)" };
+        for (auto i = 0; i < 2; ++i)
+        {
+            auto* modeMenuItem = new SqMenuItem (
+                [module, i]() { return module->params[Comp::MODE_PARAM].getValue() == i; },
+                [module, i]() { module->params[Comp::MODE_PARAM].setValue (i); });
+            modeMenuItem->text = modeNames[i];
+            menu->addChild (modeMenuItem);
+        }
+
+        for (auto paramId : { Comp::LFO_RATE_PARAM, Comp::LFO_DEPTH_PARAM })
+        {
+            auto* slider = new ui::Slider;
+            slider->quantity = module->paramQuantities[paramId];
+            slider->box.size.x = 200.0f;
+            menu->addChild (slider);
+        }
+
+        menu->addChild (new MenuEntry);
+        MenuLabel* combsLabel = new MenuLabel();
+        combsLabel->text = "Comb bank";
+        menu->addChild (combsLabel);
+
+        const float combs[] = { 1.0f, 2.0f, 3.0f, 4.0f, 8.0f };
+        const char* combNames[] = { "Single comb", "2 combs", "3 combs", "4 combs", "8 combs" };
+        for (auto i = 0; i < 5; ++i)
+        {
+            const auto comb = combs[i];
+            auto* combsMenuItem = new SqMenuItem (
+                [module, comb]() { return module->params[Comp::BANK_COMBS_PARAM].getValue() == comb; },
+                [module, comb]() { module->params[Comp::BANK_COMBS_PARAM].setValue (comb); });
+            combsMenuItem->text = combNames[i];
+            menu->addChild (combsMenuItem);
+        }
+
+        menu->addChild (new MenuEntry);
+        MenuLabel* tuningLabel = new MenuLabel();
+        tuningLabel->text = "Bank tuning";
+        menu->addChild (tuningLabel);
+
+        const char* tuningNames[] = { "Harmonic", "Major", "Minor", "Inharmonic (bar)" };
+        for (auto i = 0; i < static_cast<int> (Comp::BankTuning::COUNT); ++i)
+        {
+            auto* tuningMenuItem = new SqMenuItem (
+                [module, i]() { return module->params[Comp::BANK_TUNING_PARAM].getValue() == i; },
+                [module, i]() { module->params[Comp::BANK_TUNING_PARAM].setValue (i); });
+            tuningMenuItem->text = tuningNames[i];
+            menu->addChild (tuningMenuItem);
+        }
+
+        sspo::appendQualityMenu (menu, module, Comp::QUALITY_OVERRIDE_PARAM);
     }
 };
 
@@ -38,6 +38,13 @@ struct Eva : Module
         eva = std::make_shared<Comp> (this);
         std::shared_ptr<IComposite> icomp = Comp::getDescription();
         SqHelper::setupParams (icomp, this);
+
+        onSampleRateChange();
+    }
+
+    void onSampleRateChange() override
+    {
+        eva->setSampleRate (SqHelper::engineGetSampleRate());
     }
 
     void process (const ProcessArgs& args) override
@@ -73,6 +80,32 @@ struct MixWidget : ModuleWidget
 
         addOutput (createOutputCentered<sspo::PJ301MPort> (mm2px (Vec (7.619, 112.58)), module, Comp::MAIN_OUTPUT));
     }
+
+    void appendContextMenu (Menu* menu) override
+    {
+        auto* module = dynamic_cast<Eva*> (this->module);
+        if (module == nullptr)
+            return;
+
+        const auto gainMode = module->params[Comp::GAIN_MODE_PARAM].getValue() > 0.5f;
+        menu->addChild (new MenuEntry);
+        auto* gainModeMenuItem = new SqMenuItem (
+            [module]() { return module->params[Comp::GAIN_MODE_PARAM].getValue() > 0.5f; },
+            [module, gainMode]() { module->params[Comp::GAIN_MODE_PARAM].setValue (gainMode ? 0.0f : 1.0f); });
+        gainModeMenuItem->text = "Input gains";
+        menu->addChild (gainModeMenuItem);
+
+        if (! gainMode)
+            return;
+
+        for (auto i = 0; i < Comp::inputCount; ++i)
+        {
+            auto* slider = new ui::Slider;
+            slider->quantity = module->paramQuantities[Comp::ONE_GAIN_PARAM + i];
+            slider->box.size.x = 200.0f;
+            menu->addChild (slider);
+        }
+    }
 };
 
 Model* modelEva = createModel<Eva, MixWidget> ("Eva");
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "Hula.h"
 #include "WidgetComposite.h"
 #include "ctrl/SqMenuItem.h"
+#include "ctrl/QualityMenu.h"
 #include "widgets.h"
 #include <atomic>
 #include <assert.h>
@@ -36,6 +37,10 @@ struct Hula : Module
     }
 };
 
+/*****************************************************
+User Interface
+*****************************************************/
+
 struct HulaWidget : ModuleWidget
 {
     HulaWidget (Hula* module)
@@ -64,6 +69,82 @@ struct HulaWidget : ModuleWidget
 
         addOutput (createOutputCentered<sspo::PJ301MPort> (mm2px (Vec (25.188, 112.865)), module, Comp::MAIN_OUTPUT));
     }
+
+    void appendContextMenu (Menu* menu) override
+    {
+        auto* module = dynamic_cast<Hula*> (this->module);
+        if (module == nullptr)
+            return;
+
+        menu->addChild (new MenuEntry);
+        MenuLabel* qualityLabel = new MenuLabel();
+        qualityLabel->text = "Oversampling";
+        menu->addChild (qualityLabel);
+
+        const char* qualityNames[] = { "1x, modulation and bass", "2x oversampling", "4x oversampling", "8x oversampling", "From quality, 2x, 4x or 8x" };
+        for (auto i = 0; i <= Comp::followQuality; ++i)
+        {
+            auto* qualityMenuItem = new SqMenuItem (
+                [module, i]() { return module->params[Comp::QUALITY_PARAM].getValue() == i; },
+                [module, i]() { module->params[Comp::QUALITY_PARAM].setValue (i); });
+            qualityMenuItem->text = qualityNames[i];
+            menu->addChild (qualityMenuItem);
+        }
+
+        sspo::appendQualityMenu (menu, module, Comp::QUALITY_OVERRIDE_PARAM);
+
+        menu->addChild (new MenuEntry);
+        MenuLabel* operatorsLabel = new MenuLabel();
+        operatorsLabel->text = "Operators";
+        menu->addChild (operatorsLabel);
+
+        const char* operatorNames[] = { "Single", "2 operator FM", "4 operator FM" };
+        for (auto i = 0; i < static_cast<int> (Comp::Operators::COUNT); ++i)
+        {
+            auto* operatorsMenuItem = new SqMenuItem (
+                [module, i]() { return module->params[Comp::OPERATORS_PARAM].getValue() == i; },
+                [module, i]() { module->params[Comp::OPERATORS_PARAM].setValue (i); });
+            operatorsMenuItem->text = operatorNames[i];
+            menu->addChild (operatorsMenuItem);
+        }
+
+        const auto operators = static_cast<Comp::Operators> (module->params[Comp::OPERATORS_PARAM].getValue());
+        if (operators == Comp::Operators::SINGLE)
+            return;
+
+        menu->addChild (new MenuEntry);
+        MenuLabel* algorithmLabel = new MenuLabel();
+        algorithmLabel->text = "Algorithm";
+        menu->addChild (algorithmLabel);
+
+        const char* twoOperatorNames[] = { "2 > 1", "2 + 1" };
+        const char* fourOperatorNames[] = { "4 > 3 > 2 > 1", "4 > 3  +  2 > 1", "2 + 3 + 4 > 1", "4 > 1 + 2 + 3" };
+        const auto** algorithmNames = operators == Comp::Operators::FOUR ? fourOperatorNames : twoOperatorNames;
+        for (auto i = 0; i < Comp::algorithmCount (operators); ++i)
+        {
+            auto* algorithmMenuItem = new SqMenuItem (
+                [module, i]() { return module->params[Comp::ALGORITHM_PARAM].getValue() == i; },
+                [module, i]() { module->params[Comp::ALGORITHM_PARAM].setValue (i); });
+            algorithmMenuItem->text = algorithmNames[i];
+            menu->addChild (algorithmMenuItem);
+        }
+
+        // operator 1 uses the panel ratio knob
+        std::vector<int> operatorParams = { Comp::OP2_RATIO_PARAM, Comp::OP2_LEVEL_PARAM };
+        if (operators == Comp::Operators::FOUR)
+        {
+            for (auto paramId : { Comp::OP3_RATIO_PARAM, Comp::OP3_LEVEL_PARAM, Comp::OP4_RATIO_PARAM, Comp::OP4_LEVEL_PARAM })
+                operatorParams.push_back (paramId);
+        }
+        menu->addChild (new MenuEntry);
+        for (auto paramId : operatorParams)
+        {
+            auto* slider = new ui::Slider;
+            slider->quantity = module->paramQuantities[paramId];
+            slider->box.size.x = 200.0f;
+            menu->addChild (slider);
+        }
+    }
 };
 
 Model* modelHula = createModel<Hula, HulaWidget> ("Hula");
\ No newline at end of file
@@ -25,6 +25,7 @@
 #include "Iverson.h"
 #include "WidgetComposite.h"
 #include "ctrl/SqMenuItem.h"
+#include "ctrl/QualityMenu.h"
 #include "app/MidiDisplay.hpp"
 
 #include <sstream>
@@ -155,6 +156,7 @@ namespace sspo
 
         static constexpr int MIDI_FEEDBACK_SLOW_RATE = 10000;
         static constexpr int MIDI_FEEDBACK_FAST_RATE = 4096;
+        static constexpr int PARAM_MIDI_UPDATE_RATE = 128;
 
         std::shared_ptr<Comp> iverson;
         std::vector<midi::InputQueue> midiInputQueues{ 2 };
@@ -541,16 +543,17 @@ namespace sspo
         if (paramMidiUpdateDivider.process())
         {
             midiToParm(args);
+            paramMidiUpdateDivider.setDivision (PluginQuality::scaleDivision (PARAM_MIDI_UPDATE_RATE, iverson->getQuality()));
         }
 
         iverson->step();
         if (controllerPageUpdateDivider.process())
         {
             pageLights();
-            controllerPageUpdateDivider.setDivision ((bool) iverson->params[Comp::MIDI_FEEDBACK_DIVIDER_SLOW]
-                                                             .getValue()
-                                                         ? MIDI_FEEDBACK_SLOW_RATE
-                                                         : MIDI_FEEDBACK_FAST_RATE);
+            const auto feedbackRate = (bool) iverson->params[Comp::MIDI_FEEDBACK_DIVIDER_SLOW].getValue()
+                                          ? MIDI_FEEDBACK_SLOW_RATE
+                                          : MIDI_FEEDBACK_FAST_RATE;
+            controllerPageUpdateDivider.setDivision (PluginQuality::scaleDivision (feedbackRate, iverson->getQuality()));
         }
 
         if (midiOutStateResetDivider.process())
@@ -731,8 +734,8 @@ namespace sspo
         onSampleRateChange();
         iverson->init();
 
-        controllerPageUpdateDivider.setDivision (4096);
-        paramMidiUpdateDivider.setDivision (128);
+        controllerPageUpdateDivider.setDivision (MIDI_FEEDBACK_FAST_RATE);
+        paramMidiUpdateDivider.setDivision (PARAM_MIDI_UPDATE_RATE);
         midiOutStateResetDivider.setDivision (131072);
     }
 
@@ -1357,6 +1360,8 @@ User Interface
             ((IversonBase*) module)->iverson->params[Comp::PROB_NOTCH_WIDTH].getValue()
             == wideNotch->notch);
         menu->addChild (wideNotch);
+
+        appendQualityMenu (menu, module, Comp::QUALITY_OVERRIDE_PARAM);
     }
 
     struct IversonWidget : IversonBaseWidget
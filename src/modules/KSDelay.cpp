@@ -23,6 +23,7 @@
 #include "KSDelay.h"
 #include "WidgetComposite.h"
 #include "ctrl/SqMenuItem.h"
+#include "ctrl/QualityMenu.h"
 #include "widgets.h"
 
 using Comp = KSDelayComp<WidgetComposite>;
@@ -52,6 +53,25 @@ struct KSDelay : Module
     {
         ks->step();
     }
+
+    json_t* dataToJson() override
+    {
+        json_t* rootJ = json_object();
+        json_object_set_new (rootJ, "stretchMode", json_integer (int (ks->stretchMode)));
+        return rootJ;
+    }
+
+    void dataFromJson (json_t* rootJ) override
+    {
+        json_t* stretchModeJ = json_object_get (rootJ, "stretchMode");
+        if (stretchModeJ)
+        {
+            // ignore modes this build doesn't know, rather than casting them into the enum
+            const auto mode = json_integer_value (stretchModeJ);
+            if (mode >= int (Comp::StretchMode::RANDOM) && mode <= int (Comp::StretchMode::DETERMINISTIC))
+                ks->setStretchMode (Comp::StretchMode (mode));
+        }
+    }
 };
 
 /*****************************************************
@@ -89,9 +109,68 @@ struct KSDelayWidget : ModuleWidget
         addInput (createInput<sspo::PJ301MPort> (Vec (50, 223), module, Comp::UNISON_SPREAD_INPUT));
         addInput (createInput<sspo::PJ301MPort> (Vec (87, 223), module, Comp::UNISON_MIX_INPUT));
         addInput (createInput<sspo::PJ301MPort> (Vec (14, 266), module, Comp::STRETCH_INPUT));
+        addInput (createInput<sspo::PJ301MPort> (Vec (44, 320), module, Comp::GATE_INPUT));
 
         addOutput (createOutput<sspo::PJ301MPort> (Vec (73, 320), module, Comp::OUT_OUTPUT));
     }
+
+    void appendContextMenu (Menu* menu) override
+    {
+        auto* module = dynamic_cast<KSDelay*> (this->module);
+        if (module == nullptr)
+            return;
+
+        menu->addChild (new MenuEntry);
+        MenuLabel* stretchLabel = new MenuLabel();
+        stretchLabel->text = "Stretch";
+        menu->addChild (stretchLabel);
+
+        auto* randomMenuItem = new SqMenuItem (
+            [module]() { return module->ks->stretchMode == Comp::StretchMode::RANDOM; },
+            [module]() { module->ks->setStretchMode (Comp::StretchMode::RANDOM); });
+        randomMenuItem->text = "Random";
+        menu->addChild (randomMenuItem);
+
+        auto* deterministicMenuItem = new SqMenuItem (
+            [module]() { return module->ks->stretchMode == Comp::StretchMode::DETERMINISTIC; },
+            [module]() { module->ks->setStretchMode (Comp::StretchMode::DETERMINISTIC); });
+        deterministicMenuItem->text = "Deterministic";
+        menu->addChild (deterministicMenuItem);
+
+        menu->addChild (new MenuEntry);
+        MenuLabel* exciterLabel = new MenuLabel();
+        exciterLabel->text = "Exciter (gate input)";
+        menu->addChild (exciterLabel);
+
+        const char* exciterNames[] = { "Off", "White noise burst", "Pink noise burst", "Pluck", "Bowed noise" };
+        for (auto i = 0; i < 5; ++i)
+        {
+            auto* exciterMenuItem = new SqMenuItem (
+                [module, i]() { return module->params[Comp::EXCITER_PARAM].getValue() == i; },
+                [module, i]() { module->params[Comp::EXCITER_PARAM].setValue (i); });
+            exciterMenuItem->text = exciterNames[i];
+            menu->addChild (exciterMenuItem);
+        }
+
+        menu->addChild (new MenuEntry);
+        MenuLabel* controlRateLabel = new MenuLabel();
+        controlRateLabel->text = "Control rate";
+        menu->addChild (controlRateLabel);
+
+        const float divisions[] = { 0.0f, 1.0f, 4.0f, 16.0f, 32.0f };
+        const char* divisionNames[] = { "From quality, 32, 16 or 4", "Every sample (offline render)", "Every 4 samples", "Every 16 samples", "Every 32 samples" };
+        for (auto i = 0; i < 5; ++i)
+        {
+            const auto division = divisions[i];
+            auto* controlRateMenuItem = new SqMenuItem (
+                [module, division]() { return module->params[Comp::CONTROL_RATE_PARAM].getValue() == division; },
+                [module, division]() { module->params[Comp::CONTROL_RATE_PARAM].setValue (division); });
+            controlRateMenuItem->text = divisionNames[i];
+            menu->addChild (controlRateMenuItem);
+        }
+
+        sspo::appendQualityMenu (menu, module, Comp::QUALITY_OVERRIDE_PARAM);
+    }
 };
 
 Model* modelKSDelay = createModel<KSDelay, KSDelayWidget> ("KSDelay");
@@ -52,8 +52,50 @@ struct LaLaWidget : ModuleWidget
         addInput (createInputCentered<sspo::PJ301MPort> (mm2px (Vec (7.65, 52.668)), module, Comp::FREQ_CV_INPUT));
         addInput (createInputCentered<sspo::PJ301MPort> (mm2px (Vec (7.62, 69.806)), module, Comp::MAIN_INPUT));
 
-        addOutput (createOutputCentered<sspo::PJ301MPort> (mm2px (Vec (7.62, 87.289)), module, Comp::HIGH_OUTPUT));
-        addOutput (createOutputCentered<sspo::PJ301MPort> (mm2px (Vec (7.62, 105.809)), module, Comp::LOW_OUTPUT));
+        addOutput (createOutputCentered<sspo::PJ301MPort> (mm2px (Vec (7.62, 81.31)), module, Comp::HIGH_OUTPUT));
+        addOutput (createOutputCentered<sspo::PJ301MPort> (mm2px (Vec (7.62, 115.63)), module, Comp::LOW_OUTPUT));
+
+        // mid bands, only used in 3 and 4 band mode
+        addOutput (createOutputCentered<sspo::PJ301MPort> (mm2px (Vec (7.62, 92.75)), module, Comp::HIGH_MID_OUTPUT));
+        addOutput (createOutputCentered<sspo::PJ301MPort> (mm2px (Vec (7.62, 104.19)), module, Comp::LOW_MID_OUTPUT));
+    }
+
+    void appendContextMenu (Menu* menu) override
+    {
+        auto* module = dynamic_cast<LaLa*> (this->module);
+        if (module == nullptr)
+            return;
+
+        menu->addChild (new MenuEntry);
+        MenuLabel* bandsLabel = new MenuLabel();
+        bandsLabel->text = "Bands";
+        menu->addChild (bandsLabel);
+
+        for (auto bands = 2; bands <= 4; ++bands)
+        {
+            auto* bandsMenuItem = new SqMenuItem (
+                [module, bands]() { return module->params[Comp::BANDS_PARAM].getValue() == bands; },
+                [module, bands]() { module->params[Comp::BANDS_PARAM].setValue (bands); });
+            bandsMenuItem->text = std::to_string (bands);
+            menu->addChild (bandsMenuItem);
+        }
+
+        menu->addChild (new MenuEntry);
+        MenuLabel* spreadLabel = new MenuLabel();
+        spreadLabel->text = "Band spread";
+        menu->addChild (spreadLabel);
+
+        const float spreads[] = { 0.5f, 1.0f, 2.0f, 3.0f, 4.0f };
+        const char* spreadNames[] = { "1/2 octave", "1 octave", "2 octaves", "3 octaves", "4 octaves" };
+        for (auto i = 0; i < 5; ++i)
+        {
+            const auto spread = spreads[i];
+            auto* spreadMenuItem = new SqMenuItem (
+                [module, spread]() { return module->params[Comp::SPREAD_PARAM].getValue() == spread; },
+                [module, spread]() { module->params[Comp::SPREAD_PARAM].setValue (spread); });
+            spreadMenuItem->text = spreadNames[i];
+            menu->addChild (spreadMenuItem);
+        }
     }
 };
 
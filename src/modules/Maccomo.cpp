@@ -23,6 +23,7 @@
 #include "Maccomo.h"
 #include "WidgetComposite.h"
 #include "ctrl/SqMenuItem.h"
+#include "ctrl/QualityMenu.h"
 #include "widgets.h"
 
 using Comp = MaccomoComp<WidgetComposite>;
@@ -89,6 +90,15 @@ struct MaccomoWidget : ModuleWidget
 
         addOutput (createOutputCentered<sspo::PJ301MPort> (mm2px (Vec (41.01, 112.625)), module, Comp::MAIN_OUTPUT));
     }
+
+    void appendContextMenu (Menu* menu) override
+    {
+        auto* module = dynamic_cast<Maccomo*> (this->module);
+        if (module == nullptr)
+            return;
+
+        sspo::appendQualityMenu (menu, module, Comp::QUALITY_OVERRIDE_PARAM);
+    }
 };
 
 Model* modelMaccomo = createModel<Maccomo, MaccomoWidget> ("Maccomo");
\ No newline at end of file
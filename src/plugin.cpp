@@ -1,11 +1,54 @@
 #include "plugin.hpp"
 #include "ctrl/SqHelper.h"
+#include "PluginQuality.h"
 
 Plugin* pluginInstance = nullptr;
 
+static std::string settingsPath()
+{
+    return asset::user (pluginInstance->slug + ".json");
+}
+
+void loadPluginSettings()
+{
+    FILE* file = std::fopen (settingsPath().c_str(), "r");
+    if (file == nullptr)
+        return;
+
+    json_error_t error;
+    json_t* rootJ = json_loadf (file, 0, &error);
+    std::fclose (file);
+    if (rootJ == nullptr)
+    {
+        WARN ("StudioSixPlusOne settings file is not valid JSON, line %d: %s", error.line, error.text);
+        return;
+    }
+
+    json_t* qualityJ = json_object_get (rootJ, "quality");
+    if (qualityJ != nullptr)
+        sspo::PluginQuality::setPluginLevel (static_cast<sspo::PluginQuality::Level> (json_integer_value (qualityJ)));
+
+    json_decref (rootJ);
+}
+
+void savePluginSettings()
+{
+    json_t* rootJ = json_object();
+    json_object_set_new (rootJ, "quality", json_integer (static_cast<int> (sspo::PluginQuality::getPluginLevel())));
+
+    FILE* file = std::fopen (settingsPath().c_str(), "w");
+    if (file != nullptr)
+    {
+        json_dumpf (rootJ, file, JSON_INDENT (2));
+        std::fclose (file);
+    }
+    json_decref (rootJ);
+}
+
 void init (::rack::Plugin* p)
 {
     pluginInstance = p;
+    loadPluginSettings();
 
     p->addModel (modelKSDelay);
     p->addModel (modelMaccomo);
@@ -19,5 +62,5 @@ void init (::rack::Plugin* p)
     p->addModel (modelIversonJr);
     p->addModel (modelZilah);
     p->addModel (modelHula);
-   // p->addModel (modelAmburgh);
+    p->addModel (modelAmburgh);
 }
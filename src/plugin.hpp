@@ -5,6 +5,10 @@ using namespace ::rack;
 
 extern plugin::Plugin* pluginInstance;
 
+/// plugin wide settings, kept in the user folder, see PluginQuality.h
+void loadPluginSettings();
+void savePluginSettings();
+
 extern Model* modelKSDelay;
 extern Model* modelMaccomo;
 extern Model* modelPolyShiftRegister;
@@ -19,6 +23,6 @@ extern Model* modelIverson;
 extern Model* modelIversonJr;
 extern Model* modelZilah;
 extern Model* modelHula;
-//extern Model* modelAmburgh;
+extern Model* modelAmburgh;
 
 
@@ -39,6 +39,7 @@ extern void testEva();
 extern void testEmpty();
 extern void testAudioMath();
 extern void testCircularBuffer();
+extern void testPortSnapshot();
 extern void testLookupTable();
 extern void testAnalyzer();
 extern void testPolyShiftRegister();
@@ -46,6 +47,11 @@ extern void testTestSignal();
 extern void testKSDelay();
 extern void testCombFilter();
 extern void testMaccomo();
+extern void testHula();
+extern void testAmburgh();
+extern void testWavetable();
+extern void testSilenceDetector();
+extern void testPluginQuality();
 extern void testSaturator();
 extern void testUtilityFilter();
 extern void testLala();
@@ -106,12 +112,18 @@ int main (int argc, char** argv)
     testTestSignal();
     testAudioMath();
     testCircularBuffer();
+    testPortSnapshot();
     testLookupTable();
     testAnalyzer();
     testPolyShiftRegister();
     testKSDelay();
     testCombFilter();
     testMaccomo();
+    testHula();
+    testAmburgh();
+    testWavetable();
+    testSilenceDetector();
+    testPluginQuality();
     testUtilityFilter();
 
     printf ("Tests passed.\n");
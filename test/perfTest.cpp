@@ -27,6 +27,7 @@ SOFTWARE.
 #include <cmath>
 #include <limits>
 #include <random>
+#include <string>
 
 #include "filter.hpp"
 #include "digital.hpp"
@@ -52,9 +53,14 @@ extern double overheadOutOnly;
 #include "UtilityFilters.h"
 
 #include "KSDelay.h"
+#include "Maccomo.h"
 #include "PolyShiftRegister.h"
 #include "CombFilter.h"
 #include "Eva.h"
+#include "Hula.h"
+#include "Amburgh.h"
+#include "Wavetable.h"
+#include "LaLa.h"
 #include "Zazel.h"
 
 using float_4 = rack::simd::float_4;
@@ -274,6 +280,36 @@ static void testLookupTable()
         },
         1);
 
+    MeasureTime<float>::run (
+        overheadInOut, "fastSin2Pi float_4", [&f4]() {
+            f4[0] = TestBuffers<float>::get();
+
+            float_4 x = sspo::AudioMath::fastSin2Pi (f4);
+            return x[0];
+        },
+        1);
+
+    // Amburgh's saturation, computed and from a table keyed on input and drive
+    float_4 drive4{ 1.0f, 5.0f, 12.0f, 30.0f };
+    MeasureTime<float>::run (
+        overheadInOut, "atan saturation float_4", [&f4, &drive4]() {
+            f4[0] = TestBuffers<float>::get();
+
+            float_4 x = rack::simd::atan (drive4 * f4) / rack::simd::atan (drive4);
+            return x[0];
+        },
+        1);
+
+    auto saturationTable = sspo::AudioMath::LookupTable::makeTable2D<float> (-4.0f, 4.0f, 1.0f / 128.0f, 1.0f, 30.0f, 0.25f, [] (const float in, const float drive) { return std::atan (drive * in) / std::atan (drive); });
+    MeasureTime<float>::run (
+        overheadInOut, "LookupTable Table2D float_4", [&f4, &drive4, &saturationTable]() {
+            f4[0] = TestBuffers<float>::get();
+
+            float_4 x = sspo::AudioMath::LookupTable::process (saturationTable, f4, drive4);
+            return x[0];
+        },
+        1);
+
     MeasureTime<float>::run (
         overheadInOut, "std::sin", []() {
             float x = std::sin (TestBuffers<float>::get());
@@ -418,19 +454,87 @@ static void testHardLimiter()
 
 using KSDelay = KSDelayComp<TestComposite>;
 
-static void testKSDelay()
+static void testKSDelay (int voices, int unison, int controlDivision = 16, int sounding = -1)
+{
+    KSDelay ks;
+
+    ks.setSampleRate (44100);
+    ks.init();
+    ks.params[KSDelay::UNISON_PARAM].setValue (unison);
+    ks.params[KSDelay::CONTROL_RATE_PARAM].setValue (controlDivision);
+
+    // the silent voices go to sleep, the sounding ones are kept busy with a saw
+    if (sounding < 0)
+        sounding = voices;
+    ks.inputs[KSDelay::IN_INPUT].setChannels (voices);
+    for (auto i = 0; i < voices; ++i)
+        ks.inputs[KSDelay::IN_INPUT].setVoltage (0, i);
+
+    std::string name = "KS Delay " + std::to_string (voices) + " voices " + std::to_string (unison) + " unison control every " + std::to_string (controlDivision);
+    if (sounding != voices)
+        name += " " + std::to_string (sounding) + " sounding";
+    float phase = 0.0f;
+    MeasureTime<double>::run (
+        overheadInOut, name.c_str(), [&ks, &phase, sounding]() {
+            phase += 0.01f;
+            if (phase > 1.0f)
+                phase -= 1.0f;
+            for (auto i = 0; i < sounding; ++i)
+                ks.inputs[KSDelay::IN_INPUT].setVoltage (phase - 0.5f, i);
+            ks.step();
+            return ks.outputs[KSDelay::OUT_OUTPUT].getVoltage (0);
+        },
+        1);
+}
+
+static void testKSDelayExciter()
+{
+    KSDelay ks;
+
+    ks.setSampleRate (44100);
+    ks.init();
+    ks.params[KSDelay::UNISON_PARAM].setValue (1);
+    ks.params[KSDelay::EXCITER_PARAM].setValue (static_cast<float> (sspo::ExciterBank::Shape::PLUCK));
+    ks.inputs[KSDelay::GATE_INPUT].setChannels (16);
+
+    // every voice plucked ten times a second
+    int count = 0;
+    MeasureTime<double>::run (
+        overheadInOut, "KS Delay 16 voices pluck exciter", [&ks, &count]() {
+            auto gate = ++count % 4410 < 100 ? 10.0f : 0.0f;
+            for (auto i = 0; i < 16; ++i)
+                ks.inputs[KSDelay::GATE_INPUT].setVoltage (gate, i);
+            ks.step();
+            return ks.outputs[KSDelay::OUT_OUTPUT].getVoltage (0);
+        },
+        1);
+}
+
+/// the same plucks as testKSDelayExciter, made outside the module the way a patch would:
+/// noise, a decay envelope per voice and a VCA into IN_INPUT
+static void testKSDelayExternalExciter()
 {
     KSDelay ks;
 
     ks.setSampleRate (44100);
     ks.init();
+    ks.params[KSDelay::UNISON_PARAM].setValue (1);
+    ks.inputs[KSDelay::IN_INPUT].setChannels (16);
 
-    ks.inputs[KSDelay::IN_INPUT].setVoltage (0, 0);
-    ks.inputs[KSDelay::IN_INPUT].setChannels (1);
+    sspo::AudioMath::NoiseSource4 noise[4];
+    rack::dsp::TSchmittTrigger<float_4> triggers[4];
+    float_4 envelopes[4] = {};
+    const auto decay = std::exp (-1.0f / (0.003f * 44100.0f));
 
-    //first run 33.16 of one percent
+    int count = 0;
     MeasureTime<double>::run (
-        overheadInOut, "KS Delay", [&ks]() {
+        overheadInOut, "KS Delay 16 voices noise envelope VCA", [&]() {
+            auto gate = ++count % 4410 < 100 ? 10.0f : 0.0f;
+            for (auto g = 0; g < 4; ++g)
+            {
+                envelopes[g] = rack::simd::ifelse (triggers[g].process (gate), 1.0f, envelopes[g] * decay);
+                ks.inputs[KSDelay::IN_INPUT].setVoltageSimd (noise[g].process() * 10.0f * envelopes[g], g * 4);
+            }
             ks.step();
             return ks.outputs[KSDelay::OUT_OUTPUT].getVoltage (0);
         },
@@ -446,6 +550,8 @@ static void testEva()
     eva.inputs[eva.TWO_INPUT].setChannels (16);
     eva.inputs[eva.THREE_INPUT].setChannels (16);
     eva.inputs[eva.FOUR_INPUT].setChannels (16);
+    // a signal rather than silence, which the silence detector would stop
+    eva.inputs[eva.ONE_INPUT].setVoltage (1.0f, 0);
 
     MeasureTime<double>::run (
         overheadInOut, "Eva", [&eva]() {
@@ -455,24 +561,234 @@ static void testEva()
         1);
 }
 
+/// a mix of poly and mono cables through the per input gains
+static void testEvaGains()
+{
+    Eva eva;
+    eva.params[eva.GAIN_MODE_PARAM].setValue (1.0f);
+    for (auto i = 0; i < Eva::inputCount; ++i)
+    {
+        eva.inputs[i].setChannels (i < 4 ? 16 : 1);
+        eva.params[Eva::ONE_GAIN_PARAM + i].setValue (0.5f);
+    }
+    eva.inputs[eva.ONE_INPUT].setVoltage (1.0f, 0);
+
+    MeasureTime<double>::run (
+        overheadInOut, "Eva 8 inputs with gains", [&eva]() {
+            eva.step();
+            return eva.outputs[Eva::MAIN_OUTPUT].getVoltage (0);
+        },
+        1);
+}
+
+using Hula = HulaComp<TestComposite>;
+
+static void testHula (int voices, Hula::Quality quality = Hula::Quality::X4, Hula::Operators operators = Hula::Operators::SINGLE)
+{
+    Hula hula;
+
+    hula.setSampleRate (44100);
+    hula.init();
+    hula.params[Hula::RATIO_PARAM].setValue (1.0f);
+    hula.params[Hula::DEPTH_PARAM].setValue (0.5f);
+    hula.params[Hula::FEEDBACK_PARAM].setValue (0.3f);
+    hula.params[Hula::QUALITY_PARAM].setValue (static_cast<float> (quality));
+    hula.params[Hula::OPERATORS_PARAM].setValue (static_cast<float> (operators));
+    for (auto id : { Hula::OP2_RATIO_PARAM, Hula::OP3_RATIO_PARAM, Hula::OP4_RATIO_PARAM })
+        hula.params[id].setValue (2.0f);
+    for (auto id : { Hula::OP2_LEVEL_PARAM, Hula::OP3_LEVEL_PARAM, Hula::OP4_LEVEL_PARAM })
+        hula.params[id].setValue (0.5f);
+    hula.inputs[Hula::VOCT_INPUT].setChannels (voices);
+    hula.inputs[Hula::FM_INPUT].setChannels (voices);
+    for (auto i = 0; i < voices; ++i)
+        hula.inputs[Hula::VOCT_INPUT].setVoltage (i / 12.0f, i);
+
+    std::string name = "Hula " + std::to_string (voices) + " voices " + std::to_string (1 << static_cast<int> (quality)) + "x oversampling";
+    if (operators != Hula::Operators::SINGLE)
+        name += operators == Hula::Operators::TWO ? " 2 op" : " 4 op";
+    float phase = 0.0f;
+    MeasureTime<double>::run (
+        overheadInOut, name.c_str(), [&hula, &phase, voices]() {
+            phase += 0.01f;
+            if (phase > 1.0f)
+                phase -= 1.0f;
+            for (auto i = 0; i < voices; ++i)
+                hula.inputs[Hula::FM_INPUT].setVoltage (phase * 10.0f - 5.0f, i);
+            hula.step();
+            return hula.outputs[Hula::MAIN_OUTPUT].getVoltage (0);
+        },
+        1);
+}
+
+/// 16 voices of saw, band limited by mip levels at 1x
+static void testWavetableOscillator()
+{
+    sspo::MipmappedWavetable wavetable;
+    wavetable.setFunction ([] (const float phase) { return 2.0f * phase - 1.0f; });
+    std::array<sspo::WavetableOscillator, 4> oscillators;
+    for (auto g = 0; g < 4; ++g)
+    {
+        oscillators[g].setWavetable (&wavetable);
+        oscillators[g].setFrequency (float_4 (110.0f, 220.0f, 440.0f, 880.0f) * (g + 1.0f), 1.0f / 44100.0f);
+    }
+
+    MeasureTime<double>::run (
+        overheadInOut, "Wavetable saw 16 voices 1x", [&oscillators]() {
+            float_4 sum = 0.0f;
+            for (auto& oscillator : oscillators)
+                sum += oscillator.process();
+            return sum[0];
+        },
+        1);
+}
+
+/// the same 16 voices as a naive saw made usable by 4x oversampling, as Hula does for its sine
+static void testOversampledSaw()
+{
+    std::array<float_4, 4> phases;
+    std::array<float_4, 4> increments;
+    std::array<sspo::Decimator<4, 1, float_4>, 4> decimators;
+    for (auto g = 0; g < 4; ++g)
+    {
+        phases[g] = 0.0f;
+        increments[g] = float_4 (110.0f, 220.0f, 440.0f, 880.0f) * (g + 1.0f) / (4.0f * 44100.0f);
+    }
+
+    MeasureTime<double>::run (
+        overheadInOut, "Naive saw 16 voices 4x oversampling", [&]() {
+            float_4 sum = 0.0f;
+            float_4 buffer[4];
+            for (auto g = 0; g < 4; ++g)
+            {
+                for (auto i = 0; i < 4; ++i)
+                {
+                    buffer[i] = 2.0f * phases[g] - 1.0f;
+                    phases[g] += increments[g];
+                    phases[g] -= rack::simd::floor (phases[g]);
+                }
+                sum += decimators[g].process (buffer);
+            }
+            return sum[0];
+        },
+        1);
+}
+
+using Amburgh = AmburghComp<TestComposite>;
+
+static void testAmburgh (int voices, float controlRate = 4.0f)
+{
+    Amburgh amburgh;
+
+    amburgh.setSampleRate (44100);
+    amburgh.init();
+    amburgh.params[Amburgh::FREQUENCY_PARAM].setValue (0.5f);
+    amburgh.params[Amburgh::RESONANCE_PARAM].setValue (2.0f);
+    amburgh.params[Amburgh::DRIVE_PARAM].setValue (5.0f);
+    amburgh.params[Amburgh::CONTROL_RATE_PARAM].setValue (controlRate);
+    amburgh.inputs[Amburgh::MAIN_INPUT].setChannels (voices);
+    amburgh.inputs[Amburgh::VOCT_INPUT].setChannels (voices);
+
+    std::string name = "Amburgh " + std::to_string (voices) + " voices, control rate " + std::to_string (static_cast<int> (controlRate));
+    float phase = 0.0f;
+    MeasureTime<double>::run (
+        overheadInOut, name.c_str(), [&amburgh, &phase, voices]() {
+            phase += 0.01f;
+            if (phase > 1.0f)
+                phase -= 1.0f;
+            for (auto i = 0; i < voices; ++i)
+                amburgh.inputs[Amburgh::MAIN_INPUT].setVoltage (phase * 10.0f - 5.0f, i);
+            amburgh.step();
+            return amburgh.outputs[Amburgh::MAIN_OUTPUT].getVoltage (0);
+        },
+        1);
+}
+
+/// the Hula DSP kernel on its own, without the composite's param and port reads
+static void testHulaEngine (int voices)
+{
+    sspo::HulaEngine engine;
+    engine.setSampleRate (44100);
+    engine.init();
+    sspo::HulaEngine::Settings settings;
+    settings.depth = 0.5f;
+    settings.feedback = 0.3f;
+    engine.setSettings (settings);
+
+    const auto groups = (voices + 3) / 4;
+    sspo::HulaEngine::Inputs in[sspo::HulaEngine::maxGroups];
+    float_4 out[sspo::HulaEngine::maxGroups];
+    for (auto i = 0; i < voices; ++i)
+        in[i / 4].voct[i % 4] = i / 12.0f;
+
+    std::string name = "Hula engine " + std::to_string (voices) + " voices";
+    float phase = 0.0f;
+    MeasureTime<double>::run (
+        overheadInOut, name.c_str(), [&]() {
+            phase += 0.01f;
+            if (phase > 1.0f)
+                phase -= 1.0f;
+            for (auto group = 0; group < groups; ++group)
+                in[group].fm = phase * 10.0f - 5.0f;
+            engine.process (in, out, groups);
+            return out[0][0];
+        },
+        1);
+}
+
 using PolyShiftRegister = PolyShiftRegisterComp<TestComposite>;
 using CombFilter = CombFilterComp<TestComposite>;
 
-static void testCombFilter()
+static void testCombFilter (int voices, int combs = 1)
 {
     CombFilter cf;
 
     cf.setSampleRate (44100);
     cf.init();
+    cf.params[CombFilter::BANK_COMBS_PARAM].setValue (combs);
 
-    cf.inputs[KSDelay::IN_INPUT].setVoltage (0, 0);
-    cf.inputs[KSDelay::IN_INPUT].setChannels (1);
+    cf.inputs[CombFilter::MAIN_INPUT].setChannels (voices);
+    for (auto i = 0; i < voices; ++i)
+        cf.inputs[CombFilter::MAIN_INPUT].setVoltage (0, i);
+
+    std::string name = "Comb Filter Massarti " + std::to_string (voices) + " voices";
+    if (combs > 1)
+        name += " " + std::to_string (combs) + " comb bank";
+    float phase = 0.0f;
+    MeasureTime<double>::run (
+        overheadInOut, name.c_str(), [&cf, &phase]() {
+            // a signal rather than silence, which the silence detector would stop
+            phase += 0.01f;
+            if (phase > 1.0f)
+                phase -= 1.0f;
+            cf.inputs[CombFilter::MAIN_INPUT].setVoltage (phase * 10.0f - 5.0f, 0);
+            cf.step();
+            return cf.outputs[CombFilter::MAIN_OUTPUT].getVoltage (0);
+        },
+        1);
+}
+
+static void testModulatedDelay (int voices)
+{
+    CombFilter cf;
 
-    //first run 33.16 of one percent
+    cf.setSampleRate (44100);
+    cf.init();
+    cf.params[CombFilter::MODE_PARAM].setValue (static_cast<float> (CombFilter::Mode::MODULATED_DELAY));
+    cf.params[CombFilter::LFO_RATE_PARAM].setValue (0.5f);
+    cf.params[CombFilter::LFO_DEPTH_PARAM].setValue (0.3f);
+    cf.inputs[CombFilter::MAIN_INPUT].setChannels (voices);
+    cf.outputs[CombFilter::QUADRATURE_OUTPUT].setChannels (voices);
+
+    std::string name = "Comb Filter Massarti modulated delay stereo " + std::to_string (voices) + " voices";
+    float phase = 0.0f;
     MeasureTime<double>::run (
-        overheadInOut, "Comb Filter Massarti", [&cf]() {
+        overheadInOut, name.c_str(), [&cf, &phase]() {
+            phase += 0.01f;
+            if (phase > 1.0f)
+                phase -= 1.0f;
+            cf.inputs[CombFilter::MAIN_INPUT].setVoltage (phase * 10.0f - 5.0f, 0);
             cf.step();
-            return cf.outputs[KSDelay::OUT_OUTPUT].getVoltage (0);
+            return cf.outputs[CombFilter::MAIN_OUTPUT].getVoltage (0);
         },
         1);
 }
@@ -596,7 +912,7 @@ static void testUtilityFilters()
     MeasureTime<double>::run (
         overheadInOut, "Linkwitz-Riley lp4 set parameter", [&lw]() {
             lw.setParameters (44100.0f, TestBuffers<float>::get() * 20000.0f);
-            return lw.f1.coeffs.a0;
+            return lw.filter.sections[0].a0;
         },
         1);
 
@@ -606,6 +922,281 @@ static void testUtilityFilters()
             return lw.process (TestBuffers<float>::get());
         },
         1);
+
+    sspo::LinkwitzRileyLP4<float_4> lp4;
+    sspo::LinkwitzRileyHP4<float_4> hp4;
+    MeasureTime<double>::run (
+        overheadInOut, "Linkwitz-Riley lp4 + hp4 set and process", [&lp4, &hp4]() {
+            auto fc = float_4 (TestBuffers<float>::get() * 20000.0f);
+            lp4.setParameters (float_4 (44100.0f), fc);
+            hp4.setParameters (float_4 (44100.0f), fc);
+            auto in = float_4 (TestBuffers<float>::get());
+            return (lp4.process (in) + hp4.process (in))[0];
+        },
+        1);
+
+    sspo::LinkwitzRileyCrossover<float_4> crossover;
+    MeasureTime<double>::run (
+        overheadInOut, "Linkwitz-Riley crossover set and process", [&crossover]() {
+            crossover.setParameters (float_4 (44100.0f), float_4 (TestBuffers<float>::get() * 20000.0f));
+            float_4 low;
+            float_4 high;
+            crossover.process (float_4 (TestBuffers<float>::get()), low, high);
+            return (low + high)[0];
+        },
+        1);
+
+    MeasureTime<double>::run (
+        overheadInOut, "Linkwitz-Riley crossover process", [&crossover]() {
+            float_4 low;
+            float_4 high;
+            crossover.process (float_4 (TestBuffers<float>::get()), low, high);
+            return (low + high)[0];
+        },
+        1);
+
+    sspo::BiQuad<float_4> bq1;
+    sspo::BiQuad<float_4> bq2;
+    bq1.setButterworthLp2 (float_4 (44100.0f), float_4 (1000.0f));
+    bq2.setButterworthLp2 (float_4 (44100.0f), float_4 (1000.0f));
+    MeasureTime<double>::run (
+        overheadInOut, "Biquad x2 float_4 process", [&bq1, &bq2]() {
+            return bq2.process (bq1.process (float_4 (TestBuffers<float>::get())))[0];
+        },
+        1);
+
+    sspo::DcBlocker<float_4> dc;
+    dc.setCutoff (44100.0f, 5.5f);
+    MeasureTime<double>::run (
+        overheadInOut, "DC blocker float_4 process", [&dc]() {
+            return dc.process (float_4 (TestBuffers<float>::get()))[0];
+        },
+        1);
+
+    sspo::SOSCascade<float_4, 2> sos;
+    sos.setButterworthLp2 (float_4 (44100.0f), float_4 (1000.0f));
+    MeasureTime<double>::run (
+        overheadInOut, "SOSCascade<float_4, 2> process", [&sos]() {
+            return sos.process (float_4 (TestBuffers<float>::get()))[0];
+        },
+        1);
+}
+
+// worst level in dB of the frequencies that would alias below 16kHz, for the perf report
+template <int oversample, typename D>
+static float stopBandLevel (D& decimator)
+{
+    const double sr = 44100.0 * oversample;
+    float worst = -200.0f;
+    float buffer[oversample];
+    for (auto freq = 28500.0; freq < sr * 0.5; freq += 1500.0)
+    {
+        float peak = 0.0f;
+        auto n = 0;
+        for (auto i = 0; i < 2048; ++i)
+        {
+            for (auto j = 0; j < oversample; ++j, ++n)
+                buffer[j] = static_cast<float> (std::sin (2.0 * sspo::AudioMath::LD_PI * freq * n / sr));
+            auto y = decimator.process (buffer);
+            if (i > 1024)
+                peak = std::max (peak, std::abs (y));
+        }
+        worst = std::max (worst, sspo::AudioMath::db (peak));
+    }
+    return worst;
+}
+
+// time per output sample, float_4
+template <int oversample>
+static void testResamplers()
+{
+    using Phase = sspo::HalfBandDesign::Phase;
+
+    sspo::Decimator<oversample, 1, float> iirRejection;
+    auto name = std::to_string (oversample) + "x IIR decimator, stop band "
+                + std::to_string (int (stopBandLevel<oversample> (iirRejection))) + "dB";
+    sspo::Decimator<oversample, 1, float_4> iir;
+    float_4 buffer[oversample];
+    MeasureTime<double>::run (
+        overheadInOut, name.c_str(), [&iir, &buffer]() {
+            for (auto& b : buffer)
+                b = float_4 (TestBuffers<float>::get());
+            return iir.process (buffer)[0];
+        },
+        1);
+
+    sspo::Upsampler<oversample, 1, float_4> iirUp;
+    MeasureTime<double>::run (
+        overheadInOut, (std::to_string (oversample) + "x IIR upsampler").c_str(), [&iirUp, &buffer]() {
+            iirUp.process (float_4 (TestBuffers<float>::get()), buffer);
+            return buffer[oversample - 1][0];
+        },
+        1);
+
+    for (auto phase : { Phase::LINEAR, Phase::MINIMUM })
+    {
+        const std::string phaseName = phase == Phase::LINEAR ? " linear" : " minimum";
+        sspo::FirDecimator<oversample, float> firRejection (phase);
+        name = std::to_string (oversample) + "x FIR decimator" + phaseName + ", stop band "
+               + std::to_string (int (stopBandLevel<oversample> (firRejection))) + "dB";
+        sspo::FirDecimator<oversample, float_4> fir (phase);
+        MeasureTime<double>::run (
+            overheadInOut, name.c_str(), [&fir, &buffer]() {
+                for (auto& b : buffer)
+                    b = float_4 (TestBuffers<float>::get());
+                return fir.process (buffer)[0];
+            },
+            1);
+
+        sspo::FirUpsampler<oversample, float_4> firUp (phase);
+        MeasureTime<double>::run (
+            overheadInOut, (std::to_string (oversample) + "x FIR upsampler" + phaseName).c_str(), [&firUp, &buffer]() {
+                firUp.process (float_4 (TestBuffers<float>::get()), buffer);
+                return buffer[oversample - 1][0];
+            },
+            1);
+    }
+}
+
+using Lala = LaLaComp<TestComposite>;
+
+static void testLala (int bands)
+{
+    Lala lala;
+    lala.setSampleRate (44100);
+    lala.init();
+    lala.params[Lala::BANDS_PARAM].setValue (bands);
+    lala.inputs[Lala::MAIN_INPUT].setChannels (16);
+
+    std::string name = "LaLa 16 channels " + std::to_string (bands) + " bands";
+    float phase = 0.0f;
+    MeasureTime<double>::run (
+        overheadInOut, name.c_str(), [&lala, &phase]() {
+            // a signal rather than silence, which the silence detector would stop
+            phase += 0.01f;
+            if (phase > 1.0f)
+                phase -= 1.0f;
+            lala.inputs[Lala::MAIN_INPUT].setVoltage (phase * 10.0f - 5.0f, 0);
+            lala.step();
+            return lala.outputs[Lala::LOW_OUTPUT].getVoltage (0);
+        },
+        1);
+}
+
+/// a parked effect, 16 silent channels in once the silence detector has stopped it
+template <typename TComp>
+static void testIdle (TComp& comp, int input, int output, const char* name)
+{
+    comp.inputs[input].setChannels (16);
+    for (auto i = 0; i < 44100; ++i)
+        comp.step();
+    assert (comp.silence.isIdle());
+
+    MeasureTime<double>::run (
+        overheadInOut, name, [&comp, output]() {
+            comp.step();
+            return comp.outputs[output].getVoltage (0);
+        },
+        1);
+}
+
+using Maccomo = MaccomoComp<TestComposite>;
+
+static void testIdle()
+{
+    Maccomo maccomo;
+    maccomo.setSampleRate (44100);
+    maccomo.init();
+    maccomo.params[Maccomo::FREQUENCY_PARAM].setValue (0.5f);
+    maccomo.params[Maccomo::DRIVE_PARAM].setValue (0.6f);
+    testIdle (maccomo, Maccomo::MAIN_INPUT, Maccomo::MAIN_OUTPUT, "Maccomo 16 voices idle");
+
+    Amburgh amburgh;
+    amburgh.setSampleRate (44100);
+    amburgh.init();
+    amburgh.params[Amburgh::FREQUENCY_PARAM].setValue (0.5f);
+    amburgh.params[Amburgh::RESONANCE_PARAM].setValue (0.707f);
+    amburgh.params[Amburgh::DRIVE_PARAM].setValue (1.0f);
+    amburgh.params[Amburgh::CONTROL_RATE_PARAM].setValue (4.0f);
+    testIdle (amburgh, Amburgh::MAIN_INPUT, Amburgh::MAIN_OUTPUT, "Amburgh 16 voices idle");
+
+    Lala lala;
+    lala.setSampleRate (44100);
+    lala.init();
+    lala.params[Lala::BANDS_PARAM].setValue (4);
+    testIdle (lala, Lala::MAIN_INPUT, Lala::LOW_OUTPUT, "LaLa 16 channels 4 bands idle");
+
+    CombFilter cf;
+    cf.setSampleRate (44100);
+    cf.init();
+    cf.params[CombFilter::BANK_COMBS_PARAM].setValue (8);
+    testIdle (cf, CombFilter::MAIN_INPUT, CombFilter::MAIN_OUTPUT, "Comb Filter Massarti 16 voices 8 comb bank idle");
+
+    // as testEvaGains
+    Eva eva;
+    eva.setSampleRate (44100);
+    eva.params[Eva::GAIN_MODE_PARAM].setValue (1.0f);
+    for (auto i = 1; i < Eva::inputCount; ++i)
+    {
+        eva.inputs[i].setChannels (i < 4 ? 16 : 1);
+        eva.params[Eva::ONE_GAIN_PARAM + i].setValue (0.5f);
+    }
+    testIdle (eva, Eva::ONE_INPUT, Eva::MAIN_OUTPUT, "Eva 8 inputs with gains idle");
+}
+
+/// 16 voices of a driven ramp, at the plugin quality level the composite follows
+template <typename TComp>
+static void testQuality (TComp& comp, int input, int output, const std::string& name)
+{
+    comp.inputs[input].setChannels (16);
+    float phase = 0.0f;
+    MeasureTime<double>::run (
+        overheadInOut, name.c_str(), [&comp, &phase, input, output]() {
+            phase += 0.01f;
+            if (phase > 1.0f)
+                phase -= 1.0f;
+            for (auto i = 0; i < 16; ++i)
+                comp.inputs[input].setVoltage (phase * 10.0f - 5.0f, i);
+            comp.step();
+            return comp.outputs[output].getVoltage (0);
+        },
+        1);
+}
+
+static void testQuality()
+{
+    using namespace sspo::PluginQuality;
+    for (auto level : { Level::ECO, Level::NORMAL, Level::HIGH })
+    {
+        setPluginLevel (level);
+        const auto suffix = std::string (" 16 voices, quality ") + name (level);
+
+        Maccomo maccomo;
+        maccomo.setSampleRate (44100);
+        maccomo.init();
+        maccomo.params[Maccomo::FREQUENCY_PARAM].setValue (0.5f);
+        maccomo.params[Maccomo::DRIVE_PARAM].setValue (0.6f);
+        testQuality (maccomo, Maccomo::MAIN_INPUT, Maccomo::MAIN_OUTPUT, "Maccomo" + suffix);
+
+        // as testAmburgh, with the control rate from the quality
+        Amburgh amburgh;
+        amburgh.setSampleRate (44100);
+        amburgh.init();
+        amburgh.params[Amburgh::FREQUENCY_PARAM].setValue (0.5f);
+        amburgh.params[Amburgh::RESONANCE_PARAM].setValue (2.0f);
+        amburgh.params[Amburgh::DRIVE_PARAM].setValue (5.0f);
+        testQuality (amburgh, Amburgh::MAIN_INPUT, Amburgh::MAIN_OUTPUT, "Amburgh" + suffix);
+
+        CombFilter cf;
+        cf.setSampleRate (44100);
+        cf.init();
+        cf.params[CombFilter::MODE_PARAM].setValue (static_cast<float> (CombFilter::Mode::MODULATED_DELAY));
+        cf.params[CombFilter::LFO_RATE_PARAM].setValue (0.5f);
+        cf.params[CombFilter::LFO_DEPTH_PARAM].setValue (0.3f);
+        cf.outputs[CombFilter::QUADRATURE_OUTPUT].setChannels (16);
+        testQuality (cf, CombFilter::MAIN_INPUT, CombFilter::MAIN_OUTPUT, "Comb Filter Massarti modulated delay" + suffix);
+    }
+    setPluginLevel (Level::NORMAL);
 }
 
 void perfTest()
@@ -626,9 +1217,45 @@ void perfTest()
     testFastApprox();
     testCircularBuffer();
     testHardLimiter();
-    testKSDelay();
+    for (auto voices : { 1, 4, 8, 16 })
+    {
+        testKSDelay (voices, 1);
+        testKSDelay (voices, 7);
+    }
+    testKSDelay (16, 7, 1);
+    testKSDelay (16, 7, 16, 2);
+    testKSDelay (16, 7, 16, 0);
+    testKSDelayExciter();
+    testKSDelayExternalExciter();
     testPolyShiftRegister();
 
-    testCombFilter();
+    testCombFilter (1);
+    testCombFilter (4);
+    testCombFilter (16);
+    testCombFilter (1, 8);
+    testCombFilter (16, 8);
+    testModulatedDelay (1);
+    testModulatedDelay (16);
     testEva();
+    testEvaGains();
+    testHula (1);
+    testHula (16, Hula::Quality::X1);
+    testHula (16, Hula::Quality::X2);
+    testHula (16);
+    testHula (16, Hula::Quality::X8);
+    testHula (16, Hula::Quality::X4, Hula::Operators::TWO);
+    testHula (16, Hula::Quality::X4, Hula::Operators::FOUR);
+    testHula (16, Hula::Quality::X1, Hula::Operators::FOUR);
+    testHulaEngine (16);
+    testAmburgh (16);
+    testAmburgh (16, 1.0f);
+    testWavetableOscillator();
+    testOversampledSaw();
+    testLala (2);
+    testLala (4);
+    testIdle();
+    testQuality();
+    testResamplers<2>();
+    testResamplers<4>();
+    testResamplers<8>();
 }
\ No newline at end of file
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2020 Dave French <contact/dot/dave/dot/french3/at/googlemail/dot/com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <cmath>
+#include <limits>
+#include "TestComposite.h"
+#include "ExtremeTester.h"
+#include "asserts.h"
+
+#include "Amburgh.h"
+
+using AM = AmburghComp<TestComposite>;
+
+static void setup (AM& amburgh, int channels)
+{
+    amburgh.setSampleRate (44100);
+    amburgh.init();
+    amburgh.params[AM::FREQUENCY_PARAM].setValue (0.5f);
+    amburgh.params[AM::RESONANCE_PARAM].setValue (0.707f);
+    amburgh.params[AM::DRIVE_PARAM].setValue (1.0f);
+    amburgh.params[AM::CONTROL_RATE_PARAM].setValue (4.0f);
+    amburgh.inputs[AM::MAIN_INPUT].setChannels (channels);
+}
+
+static void testExtreme()
+{
+    AM amburgh;
+    std::vector<std::pair<float, float>> paramLimits;
+    amburgh.setSampleRate (44100);
+    amburgh.init();
+
+    paramLimits.resize (amburgh.NUM_PARAMS);
+    using fp = std::pair<float, float>;
+
+    auto iComp = AM::getDescription();
+    for (int i = 0; i < iComp->getNumParams(); ++i)
+    {
+        auto desc = iComp->getParam (i);
+        fp t (desc.min, desc.max);
+        paramLimits[i] = t;
+    }
+
+    ExtremeTester<AM>::test (amburgh, paramLimits, true, "Amburgh");
+}
+
+/// a mode change reaches every group, not just the one being processed when it changed
+static void testModeAllGroups()
+{
+    AM amburgh;
+    setup (amburgh, 16);
+    amburgh.params[AM::MODE_PARAM].setValue (1.0f); // lpf4
+    for (auto c = 0; c < 16; ++c)
+        amburgh.inputs[AM::MAIN_INPUT].setVoltage (1.0f, c);
+
+    for (auto i = 0; i < 4410; ++i)
+        amburgh.step();
+    for (auto c = 0; c < 16; ++c)
+        assertGT (std::abs (amburgh.outputs[AM::MAIN_OUTPUT].getVoltage (c)), 0.5f);
+
+    amburgh.params[AM::MODE_PARAM].setValue (3.0f); // hpf4, dc is removed
+    for (auto i = 0; i < 4410; ++i)
+        amburgh.step();
+    for (auto c = 0; c < 16; ++c)
+        assertLT (std::abs (amburgh.outputs[AM::MAIN_OUTPUT].getVoltage (c)), 0.01f);
+}
+
+/// with the controls held still, the control rate makes no difference
+static void testControlRate()
+{
+    AM full;
+    AM divided;
+    setup (full, 5);
+    setup (divided, 5);
+    full.params[AM::CONTROL_RATE_PARAM].setValue (1.0f);
+    divided.params[AM::CONTROL_RATE_PARAM].setValue (32.0f);
+    for (auto* amburgh : { &full, &divided })
+    {
+        amburgh->params[AM::RESONANCE_PARAM].setValue (3.0f);
+        amburgh->params[AM::DRIVE_PARAM].setValue (8.0f);
+        amburgh->inputs[AM::VOCT_INPUT].setChannels (5);
+        for (auto c = 0; c < 5; ++c)
+            amburgh->inputs[AM::VOCT_INPUT].setVoltage (c * 0.3f, c);
+    }
+
+    for (auto i = 0; i < 10000; ++i)
+    {
+        for (auto* amburgh : { &full, &divided })
+        {
+            for (auto c = 0; c < 5; ++c)
+                amburgh->inputs[AM::MAIN_INPUT].setVoltage (5.0f * std::sin (i * 0.01f * (c + 1)), c);
+            amburgh->step();
+        }
+        // the -120dB bootstrap noise differs between the two
+        for (auto c = 0; c < 5; ++c)
+            assertClose (full.outputs[AM::MAIN_OUTPUT].getVoltage (c), divided.outputs[AM::MAIN_OUTPUT].getVoltage (c), 0.001f);
+    }
+}
+
+/// a nan on one voice is scrubbed from the output and the filter recovers
+static void testNonFinite()
+{
+    AM amburgh;
+    setup (amburgh, 4);
+    for (auto i = 0; i < 1000; ++i)
+    {
+        for (auto c = 0; c < 4; ++c)
+            amburgh.inputs[AM::MAIN_INPUT].setVoltage (i == 500 && c == 2 ? std::numeric_limits<float>::quiet_NaN() : 1.0f, c);
+        amburgh.step();
+        for (auto c = 0; c < 4; ++c)
+            assert (std::isfinite (amburgh.outputs[AM::MAIN_OUTPUT].getVoltage (c)));
+    }
+    assertGT (std::abs (amburgh.outputs[AM::MAIN_OUTPUT].getVoltage (2)), 0.5f);
+}
+
+/// silent input goes idle with exact zeros, the first sample of new input is processed as a fresh filter would,
+/// controls moved while idle included
+static void testSilenceBypass()
+{
+    AM amburgh;
+    setup (amburgh, 4);
+    for (auto i = 0; i < 44100; ++i)
+        amburgh.step();
+    assert (amburgh.silence.isIdle());
+    for (auto c = 0; c < 4; ++c)
+        assertEQ (amburgh.outputs[AM::MAIN_OUTPUT].getVoltage (c), 0.0f);
+    assertEQ (amburgh.outputs[AM::MAIN_OUTPUT].getChannels(), 4);
+
+    AM fresh;
+    setup (fresh, 4);
+    for (auto* a : { &amburgh, &fresh })
+        a->params[AM::FREQUENCY_PARAM].setValue (0.8f);
+    for (auto i = 0; i < 100; ++i)
+    {
+        for (auto* a : { &amburgh, &fresh })
+        {
+            for (auto c = 0; c < 4; ++c)
+                a->inputs[AM::MAIN_INPUT].setVoltage (2.0f + c, c);
+            a->step();
+        }
+        assert (! amburgh.silence.isIdle());
+        for (auto c = 0; c < 4; ++c)
+            assertClose (amburgh.outputs[AM::MAIN_OUTPUT].getVoltage (c), fresh.outputs[AM::MAIN_OUTPUT].getVoltage (c), 0.0001f);
+    }
+}
+
+/// high resonance and drive can ring with no input, so that stays awake
+static void testSilenceSelfOscillation()
+{
+    AM amburgh;
+    setup (amburgh, 1);
+    amburgh.params[AM::RESONANCE_PARAM].setValue (4.0f);
+    amburgh.params[AM::DRIVE_PARAM].setValue (30.0f);
+    auto peak = 0.0f;
+    for (auto i = 0; i < 441000; ++i)
+    {
+        amburgh.step();
+        peak = std::max (peak, std::abs (amburgh.outputs[AM::MAIN_OUTPUT].getVoltage (0)));
+    }
+    assert (! amburgh.silence.isIdle());
+    assertGT (peak, 1.0f);
+}
+
+void testAmburgh()
+{
+    printf ("testAmburgh\n");
+    testExtreme();
+    testModeAllGroups();
+    testControlRate();
+    testNonFinite();
+    testSilenceBypass();
+    testSilenceSelfOscillation();
+}
@@ -97,6 +97,48 @@ static void testRand01()
     //printf ("rand01 %d \n", static_cast<int>(bands.size()));
 }
 
+static void testFastSin2Pi()
+{
+    // phases well outside one cycle, as Hula's phase plus modulation offset can be
+    for (auto p = -4.0f; p < 4.0f; p += 0.0001f)
+    {
+        auto expected = static_cast<float> (std::sin (2.0 * M_PI * p));
+        assertClose (AudioMath::fastSin2Pi (p), expected, 1e-5f);
+    }
+
+    float_4 p{ -3.3f, -0.25f, 0.1f, 2.7f };
+    float_4 r = AudioMath::fastSin2Pi (p);
+    for (auto i = 0; i < 4; ++i)
+        assertEQ (r[i], AudioMath::fastSin2Pi (p[i]));
+}
+
+static void testNoiseSource4()
+{
+    AudioMath::NoiseSource4 noise (1234);
+    std::map<int, bool> bands;
+    float_4 sum = 0.0f;
+    const auto count = 100000;
+    for (auto i = 0; i < count; ++i)
+    {
+        float_4 x = noise.process();
+        sum += x;
+        for (auto j = 0; j < 4; ++j)
+        {
+            assertGE (x[j], -0.5f);
+            assertLT (x[j], 0.5f);
+            bands[static_cast<int> ((x[j] + 0.5f) * 100)] = true;
+        }
+    }
+    assertEQ (bands.size(), 100u);
+    for (auto j = 0; j < 4; ++j)
+        assertClose (sum[j] / count, 0.0f, 0.01f);
+
+    // lanes are independent
+    float_4 x = noise.process();
+    assertNE (x[0], x[1]);
+    assertNE (x[2], x[3]);
+}
+
 static void testlinearInterpolateSimd()
 {
     float_4 a{ -10.4, 11.7, 0.004, 3.2 };
@@ -119,4 +161,6 @@ void testAudioMath()
     testlinearInterpolate();
     testlinearInterpolateSimd();
     testRand01();
+    testFastSin2Pi();
+    testNoiseSource4();
 }
@@ -97,6 +97,175 @@ void testPositiveCombPeaks (float voct, float sr)
     }
 }
 
+// strongest bin within 2% of freq
+static float bankPeak (const FFTDataCpx& response, float freq, float sr, int size)
+{
+    auto peak = 0.0f;
+    auto first = static_cast<int> (freq * 0.98f * size / sr);
+    auto last = static_cast<int> (freq * 1.02f * size / sr);
+    for (auto bin = first; bin <= last; ++bin)
+        peak = std::max (peak, response.getAbs (bin));
+    return peak;
+}
+
+static void testBankResonances()
+{
+    const auto size = 65536;
+    const auto sr = 44100.0f;
+    CF cf;
+    cf.setSampleRate (sr);
+    cf.init();
+    cf.params[cf.COMB_PARAM].setValue (1.0f);
+    cf.params[cf.FEEDBACK_PARAM].setValue (0.9f);
+    cf.params[cf.BANK_COMBS_PARAM].setValue (2.0f);
+    cf.params[cf.BANK_TUNING_PARAM].setValue (static_cast<float> (CF::BankTuning::MAJOR));
+
+    FFTDataReal fftIn (size);
+    for (auto i = 0; i < size; ++i)
+    {
+        cf.inputs[cf.MAIN_INPUT].setVoltage (i == 0 ? 1.0f : 0.0f);
+        cf.step();
+        fftIn.set (i, cf.outputs[cf.MAIN_OUTPUT].getVoltage());
+    }
+    FFTDataCpx fftOut (size);
+    FFT::forward (&fftOut, fftIn);
+
+    // C4 and the major third above both ring, the whole tone between doesn't
+    const auto root = 261.63f;
+    auto rootPeak = bankPeak (fftOut, root, sr, size);
+    auto thirdPeak = bankPeak (fftOut, root * std::pow (2.0f, 4.0f / 12.0f), sr, size);
+    auto between = bankPeak (fftOut, root * std::pow (2.0f, 2.0f / 12.0f), sr, size);
+    assertGT (rootPeak, between * 3.0f);
+    assertGT (thirdPeak, between * 3.0f);
+}
+
+static void testCubicRead()
+{
+    InterleavedCircularBuffer buffer;
+    buffer.reset (64);
+    // a ramp, which the hermite read should follow exactly
+    for (auto i = 0; i < 64; ++i)
+        buffer.writeBuffer (float_4 (static_cast<float> (i)));
+
+    float_4 delay (1.25f, 2.5f, 10.75f, 30.0f);
+    float_4 out = buffer.readBufferCubic (delay);
+    for (auto i = 0; i < 4; ++i)
+    {
+        auto expected = 63.0f - delay[i];
+        assertClose (out[i], expected, 0.0001f);
+    }
+}
+
+static void testModulatedDelay()
+{
+    const auto sr = 44100.0f;
+    CF cf;
+    cf.setSampleRate (sr);
+    cf.init();
+    cf.params[cf.MODE_PARAM].setValue (static_cast<float> (CF::Mode::MODULATED_DELAY));
+    cf.params[cf.COMB_PARAM].setValue (1.0f);
+    cf.params[cf.FEEDBACK_PARAM].setValue (0.0f);
+    cf.params[cf.LFO_RATE_PARAM].setValue (1.0f);
+    cf.params[cf.LFO_DEPTH_PARAM].setValue (0.5f);
+    // about 10ms
+    cf.params[cf.FREQUENCY_PARAM].setValue (std::log2 (100.0f / 261.63f));
+    cf.outputs[cf.QUADRATURE_OUTPUT].setChannels (1);
+
+    // a swept delay of a sine moves its pitch up and down
+    auto phase = 0.0;
+    auto lastOut = 0.0f;
+    auto crossings = 0;
+    auto maxStep = 0.0f;
+    for (auto i = 0; i < sr; ++i)
+    {
+        phase += 1000.0 / sr;
+        cf.inputs[cf.MAIN_INPUT].setVoltage (static_cast<float> (std::sin (2.0 * M_PI * phase)));
+        cf.step();
+        auto out = cf.outputs[cf.MAIN_OUTPUT].getVoltage();
+        if (i > 4410)
+        {
+            if (lastOut < 0.0f && out >= 0.0f)
+                ++crossings;
+            maxStep = std::max (maxStep, std::abs (out - lastOut));
+        }
+        lastOut = out;
+    }
+    // the dry and the swept copy beat, but stay around 1k with no jumps
+    assertClose (crossings, 900, 60);
+    assertLT (maxStep, 1.0f);
+    assertEQ (cf.outputs[cf.QUADRATURE_OUTPUT].getChannels(), 1);
+    assertNE (cf.outputs[cf.QUADRATURE_OUTPUT].getVoltage(), 0.0f);
+}
+
+/// every voice has its own lfo phase, the same input on four voices comes out four ways
+static void testModulatedDelayVoicePhases()
+{
+    const auto sr = 44100.0f;
+    CF cf;
+    cf.setSampleRate (sr);
+    cf.init();
+    cf.params[cf.MODE_PARAM].setValue (static_cast<float> (CF::Mode::MODULATED_DELAY));
+    cf.params[cf.COMB_PARAM].setValue (1.0f);
+    cf.params[cf.LFO_RATE_PARAM].setValue (1.0f);
+    cf.params[cf.LFO_DEPTH_PARAM].setValue (0.5f);
+    cf.params[cf.FREQUENCY_PARAM].setValue (std::log2 (100.0f / 261.63f));
+    cf.inputs[cf.MAIN_INPUT].setChannels (4);
+
+    auto phase = 0.0;
+    for (auto i = 0; i < sr / 4; ++i)
+    {
+        phase += 1000.0 / sr;
+        for (auto c = 0; c < 4; ++c)
+            cf.inputs[cf.MAIN_INPUT].setVoltage (static_cast<float> (std::sin (2.0 * M_PI * phase)), c);
+        cf.step();
+    }
+
+    // a quarter cycle apart
+    for (auto c = 1; c < 4; ++c)
+    {
+        auto apart = cf.lfoPhases[0][c] - cf.lfoPhases[0][c - 1];
+        assertClose (apart - std::floor (apart), 0.25f, 0.001f);
+        assertNE (cf.outputs[cf.MAIN_OUTPUT].getVoltage (c), cf.outputs[cf.MAIN_OUTPUT].getVoltage (0));
+    }
+}
+
+/// the feedback tail rings out before it goes idle, then new input is heard from its first sample
+static void testSilenceBypass()
+{
+    CF cf;
+    cf.setSampleRate (44100);
+    cf.init();
+    cf.params[CF::FEEDBACK_PARAM].setValue (0.9f);
+    cf.params[CF::COMB_PARAM].setValue (1.0f);
+    cf.params[CF::BANK_COMBS_PARAM].setValue (1.0f);
+    cf.inputs[CF::MAIN_INPUT].setChannels (1);
+    cf.inputs[CF::MAIN_INPUT].setVoltage (5.0f, 0);
+    cf.step();
+    cf.inputs[CF::MAIN_INPUT].setVoltage (0.0f, 0);
+
+    auto lastLoud = 0;
+    auto idleAt = 0;
+    for (auto i = 1; i < 441000 && idleAt == 0; ++i)
+    {
+        cf.step();
+        const auto out = std::abs (cf.outputs[CF::MAIN_OUTPUT].getVoltage (0));
+        if (cf.silence.isIdle())
+            idleAt = i;
+        else if (out > SilenceDetector::sleepLevel)
+            lastLoud = i;
+    }
+    // the tail rings on for many periods of the comb, the hold only starts once it has decayed
+    assertGT (lastLoud, 44100 / 10);
+    assertEQ (idleAt, lastLoud + static_cast<int> (SilenceDetector::holdTime * 44100));
+    cf.step();
+    assertEQ (cf.outputs[CF::MAIN_OUTPUT].getVoltage (0), 0.0f);
+
+    cf.inputs[CF::MAIN_INPUT].setVoltage (1.0f, 0);
+    cf.step();
+    assert (! cf.silence.isIdle());
+    assertGT (cf.outputs[CF::MAIN_OUTPUT].getVoltage (0), 0.5f);
+}
+
 void testCombFilter()
 {
     printf ("CombFilter \n");
@@ -105,6 +274,11 @@ void testCombFilter()
     testPositiveCombPeaks (-4.0f, 44100.0f);
     testPositiveCombPeaks (3.0f, 44100.0f);
     testPositiveCombPeaks (0.0f, 96000.0f);
+    testBankResonances();
+    testCubicRead();
+    testModulatedDelay();
+    testModulatedDelayVoicePhases();
+    testSilenceBypass();
 
     testExtreme();
 }
@@ -254,6 +254,95 @@ static void testSimdPow()
     }
 }
 
+/// the vector saturation follows the scalar curve, through the knee and past the limit
+static void testSaturateSimd()
+{
+    for (auto x = -15.0f; x < 15.0f; x += 0.01f)
+    {
+        float_4 in{ x, -x, x * 0.5f, x * 0.9f };
+        auto out = sspo::voltageSaturate (in);
+        for (auto i = 0; i < 4; ++i)
+            assertClose (out[i], sspo::voltageSaturate (in[i]), 0.0001f);
+    }
+}
+
+/// inputs are only summed while they have a cable, and the channel count follows the cables
+static void testConnectionChanges()
+{
+    Eva eva;
+    eva.params[eva.ATTENUVERTER_PARAM].setValue (1.0f);
+    eva.inputs[eva.ONE_INPUT].setChannels (1);
+    eva.inputs[eva.ONE_INPUT].setVoltage (1.0f, 0);
+    eva.inputs[eva.THREE_INPUT].setChannels (5);
+    for (auto c = 0; c < 5; ++c)
+        eva.inputs[eva.THREE_INPUT].setVoltage (c, c);
+
+    eva.step();
+    assertEQ (eva.outputs[eva.MAIN_OUTPUT].getChannels(), 5);
+    for (auto c = 0; c < 5; ++c)
+        assertClose (eva.outputs[eva.MAIN_OUTPUT].getVoltage (c), 1.0f + c, 0.00001f);
+
+    eva.inputs[eva.THREE_INPUT].setChannels (0);
+    eva.step();
+    assertEQ (eva.outputs[eva.MAIN_OUTPUT].getChannels(), 1);
+    assertClose (eva.outputs[eva.MAIN_OUTPUT].getVoltage (0), 1.0f, 0.00001f);
+
+    eva.inputs[eva.ONE_INPUT].setChannels (0);
+    eva.step();
+    assertLE (eva.outputs[eva.MAIN_OUTPUT].getChannels(), 1);
+    assertEQ (eva.outputs[eva.MAIN_OUTPUT].getVoltage (0), 0.0f);
+}
+
+static void testGainMode()
+{
+    Eva eva;
+    eva.params[eva.ATTENUVERTER_PARAM].setValue (1.0f);
+    for (auto i = 0; i < Eva::inputCount; ++i)
+    {
+        eva.inputs[i].setChannels (i % 2 ? 2 : 1);
+        eva.inputs[i].setVoltage (1.0f, 0);
+        eva.inputs[i].setVoltage (1.0f, 1);
+        eva.params[Eva::ONE_GAIN_PARAM + i].setValue (i / 10.0f);
+    }
+
+    // the gains are ignored until the mode is on
+    eva.step();
+    assertClose (eva.outputs[eva.MAIN_OUTPUT].getVoltage (0), 8.0f, 0.00001f);
+
+    eva.params[eva.GAIN_MODE_PARAM].setValue (1.0f);
+    eva.step();
+    assertClose (eva.outputs[eva.MAIN_OUTPUT].getVoltage (0), 2.8f, 0.00001f);
+    assertClose (eva.outputs[eva.MAIN_OUTPUT].getVoltage (1), 2.8f, 0.00001f);
+}
+
+/// silent inputs go idle with exact zeros, the first step with signal back is mixed as normal
+static void testSilenceBypass()
+{
+    Eva eva;
+    eva.setSampleRate (44100.0f);
+    eva.params[eva.ATTENUVERTER_PARAM].setValue (1.0f);
+    eva.inputs[eva.ONE_INPUT].setChannels (1);
+    eva.inputs[eva.TWO_INPUT].setChannels (3);
+    for (auto i = 0; i < 44100; ++i)
+        eva.step();
+    assert (eva.silence.isIdle());
+    assertEQ (eva.outputs[eva.MAIN_OUTPUT].getChannels(), 3);
+    for (auto c = 0; c < 3; ++c)
+        assertEQ (eva.outputs[eva.MAIN_OUTPUT].getVoltage (c), 0.0f);
+
+    eva.inputs[eva.TWO_INPUT].setVoltage (2.0f, 2);
+    eva.step();
+    assert (! eva.silence.isIdle());
+    assertEQ (eva.outputs[eva.MAIN_OUTPUT].getVoltage (1), 0.0f);
+    assertClose (eva.outputs[eva.MAIN_OUTPUT].getVoltage (2), 2.0f, 0.00001f);
+
+    // turning the mix down to nothing is not silence on the inputs, it still follows the attenuverter
+    eva.params[eva.ATTENUVERTER_PARAM].setValue (0.0f);
+    for (auto i = 0; i < 44100; ++i)
+        eva.step();
+    assert (! eva.silence.isIdle());
+}
+
 void testEva()
 {
     printf ("testEva\n");
@@ -263,4 +352,8 @@ void testEva()
     testMaxInputChannels();
     testMonoSumming();
     testPolySumming();
+    testSaturateSimd();
+    testConnectionChanges();
+    testGainMode();
+    testSilenceBypass();
 }
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2020 Dave French <contact/dot/dave/dot/french3/at/googlemail/dot/com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <cmath>
+#include <random>
+#include "TestComposite.h"
+#include "ExtremeTester.h"
+#include "asserts.h"
+
+#include "Hula.h"
+
+using HU = HulaComp<TestComposite>;
+
+static void testExtreme()
+{
+    HU hula;
+    std::vector<std::pair<float, float>> paramLimits;
+    hula.setSampleRate (44100);
+    hula.init();
+
+    paramLimits.resize (hula.NUM_PARAMS);
+    using fp = std::pair<float, float>;
+
+    auto iComp = HU::getDescription();
+    for (int i = 0; i < iComp->getNumParams(); ++i)
+    {
+        auto desc = iComp->getParam (i);
+        fp t (desc.min, desc.max);
+        paramLimits[i] = t;
+    }
+
+    ExtremeTester<HU>::test (hula, paramLimits, true, "Hula");
+}
+
+/// an unmodulated Hula is a sine at C4 in every quality mode
+static void testQuality (HU::Quality quality)
+{
+    HU hula;
+    hula.setSampleRate (44100);
+    hula.init();
+    hula.params[HU::RATIO_PARAM].setValue (1.0f);
+    hula.params[HU::QUALITY_PARAM].setValue (static_cast<float> (quality));
+    hula.inputs[HU::VOCT_INPUT].setChannels (1);
+    hula.inputs[HU::VOCT_INPUT].setVoltage (0.0f, 0);
+
+    // let the dc blocker settle
+    for (auto i = 0; i < 44100; ++i)
+        hula.step();
+
+    auto crossings = 0;
+    auto sumSquares = 0.0;
+    auto last = hula.outputs[HU::MAIN_OUTPUT].getVoltage (0);
+    for (auto i = 0; i < 44100; ++i)
+    {
+        hula.step();
+        auto out = hula.outputs[HU::MAIN_OUTPUT].getVoltage (0);
+        if ((out > 0.0f) != (last > 0.0f))
+            crossings++;
+        sumSquares += out * out;
+        last = out;
+    }
+
+    // +-5 cent random detune
+    assertClose (crossings / 2.0f, 261.63f, 2.0f);
+    auto rms = static_cast<float> (std::sqrt (sumSquares / 44100));
+    assertClose (rms, 5.0f / std::sqrt (2.0f), 0.3f);
+}
+
+struct Measurement
+{
+    float crossings = 0;
+    float rms = 0;
+};
+
+static Measurement measureOperators (HU::Operators operators, int algorithm, float level)
+{
+    HU hula;
+    hula.setSampleRate (44100);
+    hula.init();
+    hula.params[HU::RATIO_PARAM].setValue (1.0f);
+    hula.params[HU::QUALITY_PARAM].setValue (static_cast<float> (HU::Quality::X4));
+    hula.params[HU::OPERATORS_PARAM].setValue (static_cast<float> (operators));
+    hula.params[HU::ALGORITHM_PARAM].setValue (algorithm);
+    for (auto id : { HU::OP2_RATIO_PARAM, HU::OP3_RATIO_PARAM, HU::OP4_RATIO_PARAM })
+        hula.params[id].setValue (1.0f);
+    for (auto id : { HU::OP2_LEVEL_PARAM, HU::OP3_LEVEL_PARAM, HU::OP4_LEVEL_PARAM })
+        hula.params[id].setValue (level);
+    hula.inputs[HU::VOCT_INPUT].setChannels (16);
+
+    for (auto i = 0; i < 44100; ++i)
+        hula.step();
+
+    Measurement ret;
+    auto sumSquares = 0.0;
+    auto last = hula.outputs[HU::MAIN_OUTPUT].getVoltage (15);
+    for (auto i = 0; i < 44100; ++i)
+    {
+        hula.step();
+        auto out = hula.outputs[HU::MAIN_OUTPUT].getVoltage (15);
+        if ((out > 0.0f) != (last > 0.0f))
+            ret.crossings++;
+        sumSquares += out * out;
+        last = out;
+    }
+    ret.rms = static_cast<float> (std::sqrt (sumSquares / 44100));
+    return ret;
+}
+
+static void testOperators()
+{
+    for (auto operators : { HU::Operators::TWO, HU::Operators::FOUR })
+    {
+        for (auto algorithm = 0; algorithm < HU::algorithmCount (operators); ++algorithm)
+        {
+            // with the other operators silent only operator 1 is heard, a plain sine
+            auto silent = measureOperators (operators, algorithm, 0.0f);
+            assertClose (silent.crossings / 2.0f, 261.63f, 2.0f);
+            assertClose (silent.rms, 5.0f / std::sqrt (2.0f), 0.3f);
+
+            auto modulated = measureOperators (operators, algorithm, 1.0f);
+            assertGT (modulated.rms, 1.0f);
+            assertLT (modulated.rms, 5.0f);
+            const auto& layout = HU::getAlgorithm (operators, algorithm);
+            auto hasModulator = false;
+            for (auto target : layout.targets)
+                hasModulator |= target != 0;
+            // sidebands add zero crossings
+            if (hasModulator)
+                assertGT (modulated.crossings, 600.0f);
+        }
+    }
+}
+
+/// the kernel alone, random settings and wild inputs must never give a non finite output
+static void testEngineFuzz()
+{
+    using Engine = sspo::HulaEngine;
+    using float_4 = rack::simd::float_4;
+    std::minstd_rand generator{ 7 };
+    std::uniform_real_distribution<float> unit{ 0.0f, 1.0f };
+    auto range = [&] (float low, float high) { return low + unit (generator) * (high - low); };
+    const float extremes[] = { -1000.0f, -10.0f, 0.0f, 10.0f, 1000.0f };
+
+    Engine engine;
+    engine.setSampleRate (44100);
+    engine.init();
+    for (auto run = 0; run < 200; ++run)
+    {
+        Engine::Settings settings;
+        settings.pitch = range (-4.0f, 4.0f);
+        settings.depth = range (0.0f, 1.0f);
+        settings.feedback = range (0.0f, 1.0f);
+        settings.quality = static_cast<Engine::Quality> (run % static_cast<int> (Engine::Quality::COUNT));
+        settings.operators = static_cast<Engine::Operators> ((run / 4) % static_cast<int> (Engine::Operators::COUNT));
+        settings.algorithm = static_cast<int> (range (0.0f, 4.0f));
+        for (auto op = 0; op < Engine::maxOperators; ++op)
+        {
+            settings.ratios[op] = range (0.5f, 25.95f);
+            settings.levels[op] = op == 0 ? 1.0f : range (0.0f, 1.0f);
+        }
+        settings.depthCvConnected = run & 1;
+        settings.feedbackCvConnected = run & 2;
+        engine.setSettings (settings);
+
+        Engine::Inputs in[Engine::maxGroups];
+        float_4 out[Engine::maxGroups];
+        for (auto i = 0; i < 500; ++i)
+        {
+            for (auto& group : in)
+            {
+                for (auto lane = 0; lane < 4; ++lane)
+                {
+                    group.voct[lane] = (i % 50) ? range (-10.0f, 10.0f) : extremes[(i / 50) % 5];
+                    group.fm[lane] = (i % 70) ? range (-10.0f, 10.0f) : extremes[(i / 70) % 5];
+                    group.depthCv[lane] = range (-10.0f, 10.0f);
+                    group.feedbackCv[lane] = range (-10.0f, 10.0f);
+                }
+            }
+            engine.process (in, out, Engine::maxGroups);
+            for (auto& group : out)
+            {
+                for (auto lane = 0; lane < 4; ++lane)
+                    assert (std::isfinite (group[lane]));
+            }
+        }
+    }
+}
+
+/// at 1x the highest pitch and ratio step the phase about 160 cycles a sample, it must still wrap into 0 to 1
+static void testPhaseWrap (sspo::HulaEngine::Operators operators)
+{
+    using Engine = sspo::HulaEngine;
+    using float_4 = rack::simd::float_4;
+
+    Engine engine;
+    engine.setSampleRate (44100);
+    engine.init();
+    Engine::Settings settings;
+    settings.pitch = 4.0f;
+    settings.quality = Engine::Quality::X1;
+    settings.operators = operators;
+    for (auto& ratio : settings.ratios)
+        ratio = 25.95f;
+    engine.setSettings (settings);
+    const auto operatorCount = operators == Engine::Operators::FOUR ? 4 : (operators == Engine::Operators::TWO ? 2 : 1);
+
+    Engine::Inputs in[Engine::maxGroups];
+    for (auto& group : in)
+        group.voct = 10.0f;
+    float_4 out[Engine::maxGroups];
+    for (auto i = 0; i < 44100 * 10; ++i)
+    {
+        engine.process (in, out, Engine::maxGroups);
+        for (auto group = 0; group < Engine::maxGroups; ++group)
+        {
+            for (auto op = 0; op < operatorCount; ++op)
+            {
+                auto phase = engine.getPhase (group, op);
+                for (auto lane = 0; lane < 4; ++lane)
+                {
+                    assertGE (phase[lane], 0.0f);
+                    assertLT (phase[lane], 1.0f);
+                }
+            }
+        }
+    }
+}
+
+void testHula()
+{
+    printf ("testHula\n");
+    testExtreme();
+    for (auto i = 0; i < static_cast<int> (HU::Quality::COUNT); ++i)
+        testQuality (static_cast<HU::Quality> (i));
+    testOperators();
+    testEngineFuzz();
+    for (auto i = 0; i < static_cast<int> (sspo::HulaEngine::Operators::COUNT); ++i)
+        testPhaseWrap (static_cast<sspo::HulaEngine::Operators> (i));
+}
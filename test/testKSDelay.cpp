@@ -40,6 +40,243 @@ static void test01()
     ksd.step();
 }
 
+static void testPolyVoicesMatch()
+{
+    KSD ksd;
+    ksd.setSampleRate (44100);
+    ksd.init();
+    ksd.params[KSD::STRETCH_PARAM].setValue (0.0f);
+    ksd.params[KSD::UNISON_PARAM].setValue (1.0f);
+    ksd.inputs[KSD::IN_INPUT].setChannels (16);
+    ksd.inputs[KSD::VOCT].setChannels (16);
+    // unison phases start random per voice, line them up
+    for (auto& phase : ksd.oscphases)
+        phase = 0.0f;
+
+    auto energy = 0.0f;
+    for (auto i = 0; i < 4410; ++i)
+    {
+        auto impulse = i < 10 ? 5.0f : 0.0f;
+        for (auto c = 0; c < 16; ++c)
+            ksd.inputs[KSD::IN_INPUT].setVoltage (impulse, c);
+        ksd.step();
+
+        // every voice sees the same input and pitch, so every lane must agree
+        auto first = ksd.outputs[KSD::OUT_OUTPUT].getVoltage (0);
+        for (auto c = 1; c < 16; ++c)
+        {
+            auto out = ksd.outputs[KSD::OUT_OUTPUT].getVoltage (c);
+            assertClose (out, first, 0.0001f);
+        }
+        energy += first * first;
+    }
+    assertEQ (ksd.outputs[KSD::OUT_OUTPUT].getChannels(), 16);
+    assertGT (energy, 1.0f);
+}
+
+// with static knobs the control rate only changes how fast the ramps settle
+static void testControlRate()
+{
+    KSD full;
+    KSD divided;
+    for (auto* ksd : { &full, &divided })
+    {
+        ksd->setSampleRate (44100);
+        ksd->init();
+        ksd->params[KSD::STRETCH_PARAM].setValue (0.0f);
+        ksd->params[KSD::UNISON_PARAM].setValue (7.0f);
+        ksd->params[KSD::UNISON_SPREAD_PARAM].setValue (0.7f);
+        ksd->params[KSD::UNISON_MIX_PARAM].setValue (0.6f);
+        ksd->inputs[KSD::IN_INPUT].setChannels (1);
+        for (auto& phase : ksd->oscphases)
+            phase = 0.0f;
+    }
+    full.params[KSD::CONTROL_RATE_PARAM].setValue (1.0f);
+    divided.params[KSD::CONTROL_RATE_PARAM].setValue (32.0f);
+
+    for (auto i = 0; i < 4410; ++i)
+    {
+        auto impulse = i < 10 ? 5.0f : 0.0f;
+        full.inputs[KSD::IN_INPUT].setVoltage (impulse, 0);
+        divided.inputs[KSD::IN_INPUT].setVoltage (impulse, 0);
+        full.step();
+        divided.step();
+        auto expected = full.outputs[KSD::OUT_OUTPUT].getVoltage (0);
+        auto actual = divided.outputs[KSD::OUT_OUTPUT].getVoltage (0);
+        assertClose (actual, expected, 0.001f);
+    }
+}
+
+static float stretchedDecay (KSD::StretchMode mode, float stretch)
+{
+    KSD ksd;
+    ksd.setSampleRate (44100);
+    ksd.init();
+    ksd.setStretchMode (mode);
+    ksd.params[KSD::STRETCH_PARAM].setValue (stretch);
+    ksd.params[KSD::FEEDBACK_PARAM].setValue (0.45f);
+    ksd.params[KSD::UNISON_PARAM].setValue (1.0f);
+    ksd.inputs[KSD::IN_INPUT].setChannels (1);
+    for (auto& phase : ksd.oscphases)
+        phase = 0.0f;
+
+    // energy left in the second half second after a short burst
+    auto energy = 0.0f;
+    for (auto i = 0; i < 44100; ++i)
+    {
+        ksd.inputs[KSD::IN_INPUT].setVoltage (i < 100 ? 5.0f : 0.0f, 0);
+        ksd.step();
+        auto out = ksd.outputs[KSD::OUT_OUTPUT].getVoltage (0);
+        if (i > 22050)
+            energy += out * out;
+    }
+    return energy;
+}
+
+static void testDeterministicStretch()
+{
+    // repeatable
+    auto first = stretchedDecay (KSD::StretchMode::DETERMINISTIC, 0.5f);
+    auto second = stretchedDecay (KSD::StretchMode::DETERMINISTIC, 0.5f);
+    assertEQ (first, second);
+
+    // more stretch rings longer, like the random version
+    auto none = stretchedDecay (KSD::StretchMode::DETERMINISTIC, 0.0f);
+    auto some = stretchedDecay (KSD::StretchMode::DETERMINISTIC, 0.2f);
+    assertGT (some, none);
+    assertGT (first, some);
+
+    auto randomNone = stretchedDecay (KSD::StretchMode::RANDOM, 0.0f);
+    assertClose (none, randomNone, 0.0001f);
+    auto randomSome = stretchedDecay (KSD::StretchMode::RANDOM, 0.2f);
+    assertGT (randomSome, randomNone);
+    // and by about the same amount
+    auto ratio = some / randomSome;
+    assertClose (ratio, 1.0f, 0.25f);
+}
+
+static void testIdleSleep()
+{
+    KSD ksd;
+    ksd.setSampleRate (44100);
+    ksd.init();
+    ksd.params[KSD::UNISON_PARAM].setValue (7.0f);
+    ksd.params[KSD::UNISON_MIX_PARAM].setValue (0.5f);
+    ksd.params[KSD::FEEDBACK_PARAM].setValue (0.3f);
+    ksd.inputs[KSD::IN_INPUT].setChannels (4);
+    ksd.inputs[KSD::VOCT].setChannels (4);
+    // the unison phases come from std::rand, start them together so the first taps arrive in time
+    for (auto& phase : ksd.oscphases)
+        phase = 0.0f;
+
+    auto run = [&ksd] (int samples, float input) {
+        for (auto i = 0; i < samples; ++i)
+        {
+            for (auto c = 0; c < 4; ++c)
+                ksd.inputs[KSD::IN_INPUT].setVoltage (input, c);
+            ksd.step();
+        }
+    };
+
+    run (100, 5.0f);
+    assertNE (ksd.outputs[KSD::OUT_OUTPUT].getVoltage (2), 0.0f);
+
+    // decays, then sleeps with exact zeros
+    run (44100 * 2, 0.0f);
+    for (auto c = 0; c < 4; ++c)
+        assertEQ (ksd.outputs[KSD::OUT_OUTPUT].getVoltage (c), 0.0f);
+
+    // input wakes it straight away
+    run (5, 5.0f);
+    assertNE (ksd.outputs[KSD::OUT_OUTPUT].getVoltage (1), 0.0f);
+
+    // and so does a new note
+    const float idleSamples = KSD::idleSamples;
+    run (44100 * 2, 0.0f);
+    assertEQ (ksd.outputs[KSD::OUT_OUTPUT].getVoltage (0), 0.0f);
+    auto quiet = ksd.controls[0].quietSamples[0];
+    assertEQ (quiet, idleSamples);
+    // on the very next sample, not at the next control step
+    ksd.inputs[KSD::VOCT].setVoltage (1.0f, 0);
+    run (1, 0.0f);
+    quiet = ksd.controls[0].quietSamples[0];
+    assertLT (quiet, idleSamples);
+    assertClose (ksd.controls[0].pitch[0], 2.0f * dsp::FREQ_C4, 0.5f);
+    // the other voices had no new note and stay asleep
+    assertEQ (ksd.controls[0].quietSamples[1], idleSamples);
+}
+
+static void testExciterBank()
+{
+    sspo::ExciterBank exciters (1);
+    exciters.setSampleRate (44100);
+    float_4 low = 0.0f;
+    float_4 high = 10.0f;
+    float_4 out;
+
+    for (auto shape : { sspo::ExciterBank::Shape::WHITE_NOISE, sspo::ExciterBank::Shape::PINK_NOISE, sspo::ExciterBank::Shape::PLUCK })
+    {
+        exciters.setShape (shape);
+        // silent until the first gate
+        exciters.process (&low, &out, 1);
+        assertEQ (out[0], 0.0f);
+
+        auto peak = 0.0f;
+        for (auto i = 0; i < 44100; ++i)
+        {
+            exciters.process (i < 10 ? &high : &low, &out, 1);
+            peak = std::max (peak, std::abs (out[2]));
+        }
+        assertLE (peak, 5.0f);
+        assertGT (peak, 1.0f);
+        // a one shot burst, over before a second
+        assertEQ (out[2], 0.0f);
+        exciters.process (&low, &out, 1);
+    }
+
+    // bowing keeps going while the gate is held
+    exciters.setShape (sspo::ExciterBank::Shape::BOW);
+    auto energy = 0.0f;
+    for (auto i = 0; i < 44100; ++i)
+    {
+        exciters.process (&high, &out, 1);
+        if (i > 22050)
+            energy += out[1] * out[1];
+    }
+    assertGT (energy, 1000.0f);
+}
+
+static void testExciter()
+{
+    KSD ksd;
+    ksd.setSampleRate (44100);
+    ksd.init();
+    ksd.params[KSD::UNISON_PARAM].setValue (1.0f);
+    ksd.params[KSD::FEEDBACK_PARAM].setValue (0.4f);
+    ksd.params[KSD::EXCITER_PARAM].setValue (static_cast<float> (sspo::ExciterBank::Shape::PLUCK));
+    ksd.inputs[KSD::GATE_INPUT].setChannels (2);
+
+    for (auto i = 0; i < 1000; ++i)
+        ksd.step();
+    assertEQ (ksd.outputs[KSD::OUT_OUTPUT].getChannels(), 2);
+    assertEQ (ksd.outputs[KSD::OUT_OUTPUT].getVoltage (1), 0.0f);
+
+    // only the gated voice sounds
+    ksd.inputs[KSD::GATE_INPUT].setVoltage (10.0f, 1);
+    auto energy0 = 0.0f;
+    auto energy1 = 0.0f;
+    for (auto i = 0; i < 4410; ++i)
+    {
+        ksd.step();
+        auto out0 = ksd.outputs[KSD::OUT_OUTPUT].getVoltage (0);
+        auto out1 = ksd.outputs[KSD::OUT_OUTPUT].getVoltage (1);
+        energy0 += out0 * out0;
+        energy1 += out1 * out1;
+    }
+    assertEQ (energy0, 0.0f);
+    assertGT (energy1, 1.0f);
+}
+
 static void testExtreme()
 {
     KSD ksd;
@@ -65,5 +302,11 @@ void testKSDelay()
 {
     printf ("testKSDelay\n");
     test01();
+    testPolyVoicesMatch();
+    testControlRate();
+    testDeterministicStretch();
+    testIdleSleep();
+    testExciterBank();
+    testExciter();
     testExtreme();
 }
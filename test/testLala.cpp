@@ -28,8 +28,13 @@
 #include "digital.hpp"
 #include "math.hpp"
 #include "testSignal.h"
+#include "AudioMath.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
 
 namespace ts = sspo::TestSignal;
+using namespace sspo::AudioMath;
 
 using Lala = LaLaComp<TestComposite>;
 
@@ -61,9 +66,229 @@ static void testExtreme (float sr)
     ExtremeTester<Lala>::test (lala, paramLimits, true, "Lala");
 }
 
+// sum of the high and low bands should be flat, for 4 channels with different crossover frequencies
+static void testBandsSumFlat (float freqParam, float sr)
+{
+    Lala lala;
+    lala.setSampleRate (sr);
+    lala.init();
+
+    constexpr int channels = 4;
+    lala.params[Lala::FREQ_PARAM].setValue (freqParam);
+    lala.params[Lala::FREQ_CV_PARAM].setValue (1.0f);
+    lala.inputs[Lala::MAIN_INPUT].setChannels (channels);
+    lala.inputs[Lala::FREQ_CV_INPUT].setChannels (channels);
+    for (auto c = 0; c < channels; ++c)
+        lala.inputs[Lala::FREQ_CV_INPUT].setVoltage (c * 0.7f - 1.0f, c);
+
+    constexpr int fftSize = 1024 * 32;
+    auto driac = ts::makeDriac (fftSize);
+    std::vector<ts::Signal> signals;
+    signals.resize (channels);
+
+    for (auto x : driac)
+    {
+        for (auto c = 0; c < channels; ++c)
+            lala.inputs[Lala::MAIN_INPUT].setVoltage (x, c);
+        lala.step();
+        for (auto c = 0; c < channels; ++c)
+            signals[c].push_back (lala.outputs[Lala::LOW_OUTPUT].getVoltage (c)
+                                  + lala.outputs[Lala::HIGH_OUTPUT].getVoltage (c));
+    }
+
+    auto driacResponse = ts::getResponse (driac);
+    for (auto c = 0; c < channels; ++c)
+    {
+        auto response = ts::getResponse (signals[c]);
+
+        ts::Signal levels;
+        for (auto i = 0; i < response.size() / 2.0f; ++i)
+            levels.push_back (db (response.getAbs (i)) - db (driacResponse.getAbs (i)));
+
+        auto minval = *std::min_element (levels.begin(), levels.end());
+        auto maxval = *std::max_element (levels.begin(), levels.end());
+#if 0
+        printf ("Min %f Max %f\n", minval, maxval);
+#else
+        assertClose (maxval, 0.0f, 0.35f); //0.35dB variation at low freq
+        assertClose (minval, 0.0f, 0.002f);
+#endif
+    }
+}
+
+static void testBandsSumFlat()
+{
+    // below 60Hz the windowed fft of the long impulse response is not flat
+    for (auto f = 0.4f; f < 1.0f; f += 0.1f)
+        testBandsSumFlat (f, 44100.0f);
+    testBandsSumFlat (0.5f, 96000.0f);
+}
+
+// sum of all the bands in 3 and 4 band mode should be flat
+static void testMultibandSumFlat (int bands, float freqParam, float spread)
+{
+    Lala lala;
+    lala.setSampleRate (44100.0f);
+    lala.init();
+
+    constexpr int channels = 4;
+    lala.params[Lala::BANDS_PARAM].setValue (bands);
+    lala.params[Lala::SPREAD_PARAM].setValue (spread);
+    lala.params[Lala::FREQ_PARAM].setValue (freqParam);
+    lala.params[Lala::FREQ_CV_PARAM].setValue (1.0f);
+    lala.inputs[Lala::MAIN_INPUT].setChannels (channels);
+    lala.inputs[Lala::FREQ_CV_INPUT].setChannels (channels);
+    for (auto c = 0; c < channels; ++c)
+        lala.inputs[Lala::FREQ_CV_INPUT].setVoltage (c * 0.3f, c);
+
+    constexpr int fftSize = 1024 * 32;
+    auto driac = ts::makeDriac (fftSize);
+    std::vector<ts::Signal> signals;
+    signals.resize (channels);
+
+    for (auto x : driac)
+    {
+        for (auto c = 0; c < channels; ++c)
+            lala.inputs[Lala::MAIN_INPUT].setVoltage (x, c);
+        lala.step();
+        for (auto c = 0; c < channels; ++c)
+        {
+            auto sum = lala.outputs[Lala::LOW_OUTPUT].getVoltage (c)
+                       + lala.outputs[Lala::LOW_MID_OUTPUT].getVoltage (c)
+                       + lala.outputs[Lala::HIGH_OUTPUT].getVoltage (c);
+            if (bands == 4)
+                sum += lala.outputs[Lala::HIGH_MID_OUTPUT].getVoltage (c);
+            signals[c].push_back (sum);
+        }
+    }
+
+    const int lowMidChannels = lala.outputs[Lala::LOW_MID_OUTPUT].getChannels();
+    const int highMidChannels = lala.outputs[Lala::HIGH_MID_OUTPUT].getChannels();
+    assertEQ (lowMidChannels, channels);
+    assertEQ (highMidChannels, (bands == 4 ? channels : 1));
+
+    auto driacResponse = ts::getResponse (driac);
+    for (auto c = 0; c < channels; ++c)
+    {
+        auto response = ts::getResponse (signals[c]);
+
+        ts::Signal levels;
+        for (auto i = 0; i < response.size() / 2.0f; ++i)
+            levels.push_back (db (response.getAbs (i)) - db (driacResponse.getAbs (i)));
+
+        auto minval = *std::min_element (levels.begin(), levels.end());
+        auto maxval = *std::max_element (levels.begin(), levels.end());
+        assertClose (maxval, 0.0f, 0.35f);
+        assertClose (minval, 0.0f, 0.002f);
+    }
+}
+
+// a sine in the middle of each band should come out of that band's output only
+static void testMultibandSeparation()
+{
+    Lala lala;
+    const float sr = 44100.0f;
+    lala.setSampleRate (sr);
+    lala.init();
+    lala.params[Lala::BANDS_PARAM].setValue (4);
+    lala.params[Lala::SPREAD_PARAM].setValue (2.0f);
+    lala.params[Lala::FREQ_PARAM].setValue (0.5f + 0.2f); // C4 * 4
+    lala.inputs[Lala::MAIN_INPUT].setChannels (1);
+
+    // splits at C4, C4 * 4, C4 * 16, test an octave from the splits
+    const float centre = dsp::FREQ_C4 * 4.0f;
+    const float testFreqs[] = { centre / 8.0f, centre / 2.0f, centre * 2.0f, centre * 8.0f };
+    const int outputs[] = { Lala::LOW_OUTPUT, Lala::LOW_MID_OUTPUT, Lala::HIGH_MID_OUTPUT, Lala::HIGH_OUTPUT };
+
+    for (auto band = 0; band < 4; ++band)
+    {
+        std::array<float, 4> peaks{};
+        for (auto i = 0; i < 44100; ++i)
+        {
+            lala.inputs[Lala::MAIN_INPUT].setVoltage (5.0f * std::sin (2.0f * k_pi * testFreqs[band] * i / sr));
+            lala.step();
+            if (i < 22050)
+                continue;
+            for (auto o = 0; o < 4; ++o)
+                peaks[o] = std::max (peaks[o], std::abs (lala.outputs[outputs[o]].getVoltage()));
+        }
+        for (auto o = 0; o < 4; ++o)
+        {
+            auto peak = peaks[o];
+            if (o == band)
+            {
+                assertGT (peak, 4.0f);
+            }
+            else
+            {
+                assertLT (peak, 1.0f);
+            }
+        }
+    }
+}
+
+static void testMultiband()
+{
+    // as with two bands, keep the lowest split above 60Hz
+    for (auto f = 0.5f; f < 0.8f; f += 0.1f)
+    {
+        testMultibandSumFlat (3, f, 2.0f);
+        testMultibandSumFlat (4, f, 2.0f);
+    }
+    testMultibandSumFlat (3, 0.6f, 0.5f);
+    testMultibandSumFlat (4, 0.7f, 3.0f);
+    testMultibandSeparation();
+}
+
+/// silent input goes idle with exact zeros on every band in use, new input is split from its first sample
+static void testSilenceBypass (int bands)
+{
+    Lala lala;
+    Lala fresh;
+    for (auto* l : { &lala, &fresh })
+    {
+        l->setSampleRate (44100.0f);
+        l->init();
+        l->params[Lala::FREQ_PARAM].setValue (0.5f);
+        l->params[Lala::SPREAD_PARAM].setValue (2.0f);
+        l->params[Lala::BANDS_PARAM].setValue (static_cast<float> (bands));
+        l->inputs[Lala::MAIN_INPUT].setChannels (4);
+    }
+    const int outputs[] = { Lala::LOW_OUTPUT, Lala::LOW_MID_OUTPUT, Lala::HIGH_MID_OUTPUT, Lala::HIGH_OUTPUT };
+
+    for (auto i = 0; i < 44100; ++i)
+        lala.step();
+    assert (lala.silence.isIdle());
+    for (auto o : outputs)
+    {
+        assertEQ (lala.outputs[o].getVoltage (0), 0.0f);
+        assertEQ (lala.outputs[o].getVoltage (3), 0.0f);
+    }
+
+    for (auto i = 0; i < 100; ++i)
+    {
+        for (auto* l : { &lala, &fresh })
+        {
+            for (auto c = 0; c < 4; ++c)
+                l->inputs[Lala::MAIN_INPUT].setVoltage (std::sin (0.1f * (i + 1) * (c + 1)), c);
+            l->step();
+        }
+        assert (! lala.silence.isIdle());
+        for (auto o : outputs)
+        {
+            for (auto c = 0; c < 4; ++c)
+                assertClose (lala.outputs[o].getVoltage (c), fresh.outputs[o].getVoltage (c), 0.00001f);
+        }
+    }
+}
+
 void testLala()
 {
     printf ("testLala\n");
     test01();
     testExtreme (96000.0f);
+    testBandsSumFlat();
+    testMultiband();
+    testSilenceBypass (2);
+    testSilenceBypass (4);
 }
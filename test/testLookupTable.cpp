@@ -23,6 +23,7 @@
 
 #include <asserts.h>
 #include <cmath>
+#include <limits>
 #include <stdio.h>
 
 using namespace sspo::AudioMath;
@@ -95,10 +96,53 @@ static void testConsumeSimd()
     printf ("testConsumeSimd Test Lookup ok");
 }
 
+static void testTable2D()
+{
+    auto saturate = [] (const float in, const float drive) { return std::atan (drive * in) / std::atan (drive); };
+    auto table = LookupTable::makeTable2D<float> (-4.0f, 4.0f, 1.0f / 128.0f, 1.0f, 30.0f, 0.25f, saturate);
+    assertEQ (table.sizeX, 1025);
+    assertEQ (table.sizeY, 117);
+    assertEQ (static_cast<int> (table.table.size()), table.sizeX * table.sizeY);
+
+    // between the grid points on both axes
+    for (auto drive = 1.0f; drive <= 30.0f; drive += 0.37f)
+    {
+        for (auto in = -3.0f; in <= 3.0f; in += 0.0013f)
+            assertClose (LookupTable::process (table, in, drive), saturate (in, drive), 0.01f);
+    }
+
+    // the vector path matches the scalar one lane by lane
+    for (auto in = -4.0f; in <= 4.0f; in += 0.011f)
+    {
+        float_4 x{ in, -in, in * 0.5f, in * 0.25f };
+        float_4 y{ 1.0f, 7.3f, 15.9f, 30.0f };
+        float_4 r = LookupTable::process (table, x, y);
+        for (auto i = 0; i < 4; ++i)
+            assertClose (r[i], LookupTable::process (table, x[i], y[i]), 1e-6f);
+    }
+
+    // outside the table the edge values are held
+    assertClose (LookupTable::process (table, 100.0f, 0.0f), saturate (4.0f, 1.0f), 1e-5f);
+    assertClose (LookupTable::process (table, -100.0f, 100.0f), saturate (-4.0f, 30.0f), 1e-5f);
+    float_4 r = LookupTable::process (table, float_4 (-100.0f), float_4 (100.0f));
+    assertClose (r[0], saturate (-4.0f, 30.0f), 1e-5f);
+
+    // a NaN reads the low edge rather than indexing outside the table
+    const auto nan = std::numeric_limits<float>::quiet_NaN();
+    assertClose (LookupTable::process (table, nan, 10.0f), saturate (-4.0f, 10.0f), 1e-5f);
+    assertClose (LookupTable::process (table, 2.0f, nan), saturate (2.0f, 1.0f), 1e-5f);
+    assertClose (LookupTable::process (table, nan, nan), saturate (-4.0f, 1.0f), 1e-5f);
+    r = LookupTable::process (table, float_4 (nan, 2.0f, nan, 0.0f), float_4 (10.0f, nan, nan, 1.0f));
+    assertClose (r[0], saturate (-4.0f, 10.0f), 1e-5f);
+    assertClose (r[1], saturate (2.0f, 1.0f), 1e-5f);
+    assertClose (r[2], saturate (-4.0f, 1.0f), 1e-5f);
+}
+
 void testLookupTable()
 {
     printf ("testLookupTable\n");
     testCreate();
     testConsume();
     testConsumeSimd();
+    testTable2D();
 }
@@ -117,9 +117,70 @@ static void testSelfOscillate()
     testSelfOscillate (4.0f, 44100);
 }
 
+static void setupIdle (MA& ma)
+{
+    ma.setSampleRate (44100);
+    ma.init();
+    ma.params[MA::FREQUENCY_PARAM].setValue (0.5f);
+    ma.params[MA::RESONANCE_PARAM].setValue (1.0f);
+    ma.params[MA::DRIVE_PARAM].setValue (1.0f);
+    ma.inputs[MA::MAIN_INPUT].setChannels (1);
+}
+
+/// silent input goes idle with exact zeros, the first sample of new input is processed as a fresh filter would
+static void testSilenceBypass()
+{
+    MA ma;
+    setupIdle (ma);
+    for (auto i = 0; i < 44100; ++i)
+        ma.step();
+    assert (ma.silence.isIdle());
+    assertEQ (ma.outputs[MA::MAIN_OUTPUT].getVoltage (0), 0.0f);
+
+    MA fresh;
+    setupIdle (fresh);
+    for (auto i = 0; i < 100; ++i)
+    {
+        for (auto* m : { &ma, &fresh })
+        {
+            m->inputs[MA::MAIN_INPUT].setVoltage (5.0f, 0);
+            m->step();
+        }
+        assert (! ma.silence.isIdle());
+        assertNE (ma.outputs[MA::MAIN_OUTPUT].getVoltage (0), 0.0f);
+        // only the -120dB bootstrap noise differs
+        assertClose (ma.outputs[MA::MAIN_OUTPUT].getVoltage (0), fresh.outputs[MA::MAIN_OUTPUT].getVoltage (0), 0.0001f);
+    }
+}
+
+/// with the resonance up far enough to ring with no input it stays awake, and wakes when turned up
+static void testSilenceSelfOscillation()
+{
+    MA ma;
+    setupIdle (ma);
+    for (auto i = 0; i < 44100; ++i)
+        ma.step();
+    assert (ma.silence.isIdle());
+
+    ma.params[MA::RESONANCE_PARAM].setValue (9.0f);
+    ma.params[MA::DRIVE_PARAM].setValue (2.0f);
+    ma.step();
+    assert (! ma.silence.isIdle());
+    auto peak = 0.0f;
+    for (auto i = 0; i < 441000; ++i)
+    {
+        ma.step();
+        peak = std::max (peak, std::abs (ma.outputs[MA::MAIN_OUTPUT].getVoltage (0)));
+    }
+    assert (! ma.silence.isIdle());
+    assertGT (peak, 1.0f);
+}
+
 void testMaccomo()
 {
     printf ("testMaccomo\n");
     testExtreme();
     testSelfOscillate();
+    testSilenceBypass();
+    testSilenceSelfOscillation();
 }
\ No newline at end of file
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2020 Dave French <contact/dot/dave/dot/french3/at/googlemail/dot/com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+
+#include "TestComposite.h"
+#include "PluginQuality.h"
+#include "Amburgh.h"
+#include "KSDelay.h"
+#include "Maccomo.h"
+#include "asserts.h"
+#include <assert.h>
+#include <stdio.h>
+
+using namespace sspo::PluginQuality;
+
+static void testResolve()
+{
+    setPluginLevel (Level::ECO);
+    assert (resolve (followPlugin) == Level::ECO);
+    assert (resolve (1.0f) == Level::ECO);
+    assert (resolve (2.0f) == Level::NORMAL);
+    assert (resolve (3.0f) == Level::HIGH);
+
+    // an override follows its own value whatever the plugin is set to
+    setPluginLevel (Level::HIGH);
+    assert (resolve (followPlugin) == Level::HIGH);
+    assert (resolve (2.0f) == Level::NORMAL);
+
+    // out of range values from an old or edited patch follow the plugin
+    assert (resolve (-1.0f) == Level::HIGH);
+    assert (resolve (7.0f) == Level::HIGH);
+
+    setPluginLevel (static_cast<Level> (9));
+    assert (getPluginLevel() == Level::HIGH);
+    setPluginLevel (Level::NORMAL);
+}
+
+static void testScaleDivision()
+{
+    assertEQ (scaleDivision (512, Level::ECO), 1024);
+    assertEQ (scaleDivision (512, Level::NORMAL), 512);
+    assertEQ (scaleDivision (512, Level::HIGH), 256);
+    assertEQ (scaleDivision (1, Level::HIGH), 1);
+}
+
+/// a control rate of 0 takes the division from the quality, which matches the menu's explicit division
+template <typename TComp>
+static void testFollowControlRate (Level level, float division, int input, int output)
+{
+    TComp follow;
+    TComp fixed;
+    for (auto* comp : { &follow, &fixed })
+    {
+        comp->setSampleRate (44100);
+        comp->init();
+        comp->params[TComp::QUALITY_OVERRIDE_PARAM].setValue (static_cast<float> (level) + 1.0f);
+        comp->inputs[input].setChannels (1);
+    }
+    follow.params[TComp::CONTROL_RATE_PARAM].setValue (0.0f);
+    fixed.params[TComp::CONTROL_RATE_PARAM].setValue (division);
+
+    for (auto i = 0; i < 4410; ++i)
+    {
+        for (auto* comp : { &follow, &fixed })
+        {
+            // a step each control period, so the division changes the output
+            comp->inputs[input].setVoltage (i % 37 < 5 ? 5.0f : 0.0f, 0);
+            comp->step();
+        }
+        assertClose (follow.outputs[output].getVoltage (0), fixed.outputs[output].getVoltage (0), 0.0001f);
+    }
+}
+
+/// High oversamples Maccomo's saturation, a driven sine keeps its level
+static void testMaccomoHigh()
+{
+    using MA = MaccomoComp<TestComposite>;
+    MA normal;
+    MA high;
+    float rms[2] = { 0.0f, 0.0f };
+    auto index = 0;
+    for (auto* ma : { &normal, &high })
+    {
+        ma->setSampleRate (44100);
+        ma->init();
+        ma->params[MA::FREQUENCY_PARAM].setValue (0.8f);
+        ma->params[MA::RESONANCE_PARAM].setValue (1.0f);
+        ma->params[MA::DRIVE_PARAM].setValue (2.0f);
+        ma->params[MA::QUALITY_OVERRIDE_PARAM].setValue (static_cast<float> (ma == &high ? Level::HIGH : Level::NORMAL) + 1.0f);
+        ma->inputs[MA::MAIN_INPUT].setChannels (1);
+
+        auto sum = 0.0f;
+        for (auto i = 0; i < 44100; ++i)
+        {
+            ma->inputs[MA::MAIN_INPUT].setVoltage (5.0f * std::sin (2.0f * M_PI * 110.0f * i / 44100.0f), 0);
+            ma->step();
+            const auto out = ma->outputs[MA::MAIN_OUTPUT].getVoltage (0);
+            assert (std::isfinite (out));
+            if (i >= 22050)
+                sum += out * out;
+        }
+        rms[index++] = std::sqrt (sum / 22050.0f);
+    }
+    assertGT (rms[0], 0.5f);
+    assertClose (rms[1], rms[0], rms[0] * 0.1f);
+}
+
+void testPluginQuality()
+{
+    printf ("testPluginQuality\n");
+    testResolve();
+    testScaleDivision();
+    testMaccomoHigh();
+
+    using AM = AmburghComp<TestComposite>;
+    testFollowControlRate<AM> (Level::ECO, 16.0f, AM::MAIN_INPUT, AM::MAIN_OUTPUT);
+    testFollowControlRate<AM> (Level::HIGH, 1.0f, AM::MAIN_INPUT, AM::MAIN_OUTPUT);
+
+    using KSD = KSDelayComp<TestComposite>;
+    testFollowControlRate<KSD> (Level::ECO, 32.0f, KSD::IN_INPUT, KSD::OUT_OUTPUT);
+    testFollowControlRate<KSD> (Level::HIGH, 4.0f, KSD::IN_INPUT, KSD::OUT_OUTPUT);
+}
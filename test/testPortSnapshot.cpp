@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2020 Dave French <contact/dot/dave/dot/french3/at/googlemail/dot/com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "TestComposite.h"
+#include "PortSnapshot.h"
+#include "asserts.h"
+#include <assert.h>
+#include <stdio.h>
+
+static void testMonoBroadcast()
+{
+    Input in;
+    in.setChannels (1);
+    in.setVoltage (3.0f, 0);
+
+    InputSnapshot snapshot;
+    snapshot.read (in);
+    assertEQ (snapshot.channels, 1);
+    for (auto c = 0; c < 16; ++c)
+        assertEQ (snapshot[c], 3.0f);
+
+    snapshot.read (in, false);
+    assertEQ (snapshot[0], 3.0f);
+    assertEQ (snapshot[1], 0.0f);
+}
+
+static void testPolyRead()
+{
+    Input in;
+    in.setChannels (6);
+    for (auto c = 0; c < 6; ++c)
+        in.setVoltage (float (c), c);
+
+    InputSnapshot snapshot;
+    snapshot.read (in);
+    assertEQ (snapshot.channels, 6);
+    for (auto c = 0; c < 6; ++c)
+        assertEQ (snapshot[c], float (c));
+    auto second = snapshot.getSimd (4);
+    assertEQ (second[1], 5.0f);
+    assertEQ (second[2], 0.0f);
+}
+
+static void testConnectedMask()
+{
+    std::vector<Input> inputs (4);
+    inputs[1].setChannels (1);
+    inputs[3].setChannels (3);
+
+    InputSnapshots<3> snapshots;
+    snapshots.read (inputs, { 0, 1, 3 });
+    assertEQ (snapshots.connected, 6u);
+    assert (! snapshots.isConnected (0));
+    assert (snapshots.isConnected (1));
+    assert (snapshots.isConnected (2));
+}
+
+static void testOutputWrite()
+{
+    Output out;
+    OutputSnapshot snapshot;
+    for (auto c = 0; c < 16; ++c)
+        snapshot[c] = 1.0f + c;
+
+    snapshot.write (out, 5);
+    assertEQ (out.getChannels(), 5);
+    for (auto c = 0; c < 5; ++c)
+        assertEQ (out.getVoltage (c), 1.0f + c);
+    // the rest of the last group is cleared
+    for (auto c = 5; c < 8; ++c)
+        assertEQ (out.getVoltage (c), 0.0f);
+}
+
+void testPortSnapshot()
+{
+    printf ("testPortSnapshot\n");
+    testMonoBroadcast();
+    testPolyRead();
+    testConnectedMask();
+    testOutputWrite();
+}
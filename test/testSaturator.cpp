@@ -27,6 +27,7 @@
 
 #include "asserts.h"
 #include <stdio.h>
+#include <cmath>
 #include <limits>
 #include "HardLimiter.h"
 
@@ -106,6 +107,34 @@ static void testVoltageSaturator()
         assertClose (sspo::voltageSaturate (i), sat.process (i), epslion);
 }
 
+/// the division sets how often the envelope runs, a loud sine is held down at the 8, 4 and 2
+/// the quality levels use, with a little more overshoot the less often the peak is looked at
+static void testLimiterDivision()
+{
+    const int divisions[] = { 8, 4, 2 };
+    float peaks[3];
+    for (auto i = 0; i < 3; ++i)
+    {
+        sspo::Compressor limiter;
+        limiter.setTimes (0.0f, 0.0025f);
+        limiter.setSampleRate (44100.0f);
+        limiter.threshold = -0.5f;
+        limiter.setDivision (divisions[i]);
+
+        auto peak = 0.0f;
+        for (auto n = 0; n < 22050; ++n)
+        {
+            auto out = limiter.process (4.0f * std::sin (2.0f * static_cast<float> (M_PI) * 100.0f * n / 44100.0f));
+            if (n > 17640)
+                peak = std::max (peak, std::abs (out));
+        }
+        peaks[i] = peak;
+    }
+    assertLT (peaks[0], 1.25f);
+    assertLT (peaks[1], peaks[0]);
+    assertLE (peaks[2], peaks[1]);
+}
+
 void testSaturator()
 {
     printf ("testSaturator\n");
@@ -119,4 +148,5 @@ void testSaturator()
     testInfinate (11.7f, 0.5f);
     testDefaultConstructor();
     testVoltageSaturator();
+    testLimiterDivision();
 }
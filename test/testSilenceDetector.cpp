@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2020 Dave French <contact/dot/dave/dot/french3/at/googlemail/dot/com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include "TestComposite.h"
+#include "SilenceDetector.h"
+#include "asserts.h"
+#include <assert.h>
+#include <stdio.h>
+
+static void testHold()
+{
+    SilenceDetector silence;
+    silence.setSampleRate (1000.0f);
+    const auto hold = static_cast<int> (SilenceDetector::holdTime * 1000.0f);
+
+    // a tail still ringing on the output keeps it awake
+    for (auto i = 0; i < hold * 2; ++i)
+        assert (! silence.process (0.0f, 0.1f));
+    assert (! silence.isIdle());
+
+    for (auto i = 0; i < hold - 1; ++i)
+        assert (! silence.process (0.0f, 0.0f));
+    assert (! silence.isIdle());
+    assert (silence.process (0.0f, 0.0f));
+    assert (silence.isIdle());
+}
+
+static void testHysteresis()
+{
+    SilenceDetector silence;
+    silence.setSampleRate (1000.0f);
+    while (! silence.process (0.0f, 0.0f))
+        ;
+
+    // between the two levels, too quiet to wake
+    const auto between = (SilenceDetector::sleepLevel + SilenceDetector::wakeLevel) / 2.0f;
+    assert (! silence.wake (between));
+    assert (silence.isIdle());
+    assert (silence.wake (SilenceDetector::wakeLevel));
+    assert (! silence.isIdle());
+
+    // and once awake, loud enough to stay awake
+    for (auto i = 0; i < 10000; ++i)
+        assert (! silence.process (between, 0.0f));
+
+    silence.keepAwake();
+    assert (! silence.isIdle());
+}
+
+static void testPeak()
+{
+    Input in;
+    in.setChannels (6);
+    for (auto c = 0; c < 8; ++c)
+        in.setVoltage (c == 3 ? -2.0f : 1.0f, c);
+    // stale voltages past the channel count are ignored
+    in.voltages[6] = 5.0f;
+    in.voltages[7] = 5.0f;
+    assertEQ (SilenceDetector::peak (in), 2.0f);
+
+    Input disconnected;
+    assertEQ (SilenceDetector::peak (disconnected), 0.0f);
+}
+
+static void testWriteSilence()
+{
+    Output out;
+    out.setChannels (5);
+    for (auto c = 0; c < 5; ++c)
+        out.setVoltage (1.0f, c);
+
+    SilenceDetector::writeSilence (out, 5);
+    assertEQ (out.getChannels(), 5);
+    for (auto c = 0; c < 5; ++c)
+        assertEQ (out.getVoltage (c), 0.0f);
+
+    out.setVoltage (1.0f, 0);
+    SilenceDetector::writeSilence (out, 0);
+    assertEQ (out.getVoltage (0), 0.0f);
+}
+
+void testSilenceDetector()
+{
+    printf ("testSilenceDetector\n");
+    testHold();
+    testHysteresis();
+    testPeak();
+    testWriteSilence();
+}
@@ -85,16 +85,19 @@ static void testOnePoleImpulse (std::string filename,
     assert (ts::areSame (impulse, test));
 }
 
-static void testMoogLadderSlope (SynthFilter<float>::Type type,
-                                 const float cutoff,
-                                 const float sr,
-                                 const float expected,
-                                 const float tol = 1.5f)
+static float moogLadderSlope (SynthFilter<float>::Type type,
+                              const float cutoff,
+                              const float sr,
+                              const float q = 0.0f,
+                              const bool oversample = false,
+                              const sspo::Resampler resampler = sspo::Resampler::IIR)
 {
     MoogLadderFilter<float> filter;
     filter.setType (type);
     filter.setUseNonLinearProcessing (true);
-    filter.setParameters (cutoff, 0.0f, 1.1f, 0.0f, sr);
+    filter.setUseOversample (oversample);
+    filter.setResampler (resampler);
+    filter.setParameters (cutoff, q, 1.1f, 0.0f, sr);
     filter.nonLinearProcess = [] (float a, float b) { return a * b; };
 
     constexpr int fftSize = 1024 * 32;
@@ -108,9 +111,18 @@ static void testMoogLadderSlope (SynthFilter<float>::Type type,
 
     auto response = ts::getResponse (signal);
 
-    auto slope = (type == SynthFilter<float>::Type::LPF2 || type == SynthFilter<float>::Type::LPF4)
-                     ? Analyzer::getSlopeLowpass (response, cutoff, sr)
-                     : Analyzer::getSlopeHighpass (response, cutoff, sr);
+    return (type == SynthFilter<float>::Type::LPF2 || type == SynthFilter<float>::Type::LPF4)
+               ? Analyzer::getSlopeLowpass (response, cutoff, sr)
+               : Analyzer::getSlopeHighpass (response, cutoff, sr);
+}
+
+static void testMoogLadderSlope (SynthFilter<float>::Type type,
+                                 const float cutoff,
+                                 const float sr,
+                                 const float expected,
+                                 const float tol = 1.5f)
+{
+    auto slope = moogLadderSlope (type, cutoff, sr);
 
     //printf ("lop pass %d %f %f %f\n", int (type), cutoff, sr, slope);
 
@@ -170,6 +182,53 @@ static void testMoogLPHP()
     testMoogLadderSlope (SynthFilter<float>::Type::HPF4, 2000.0, 48000, -17.0);
 }
 
+// steady state gain of a sine, in dB
+static float moogLadderGain (SynthFilter<float>::Type type,
+                             const float freq,
+                             const bool oversample,
+                             const sspo::Resampler resampler)
+{
+    const float sr = 44100.0f;
+    MoogLadderFilter<float> filter;
+    filter.setType (type);
+    filter.setUseNonLinearProcessing (true);
+    filter.setUseOversample (oversample);
+    filter.setResampler (resampler);
+    filter.setParameters (1000.0f, 1.0f, 1.0f, 0.0f, sr);
+    filter.nonLinearProcess = [] (float a, float b) { return a * b; };
+
+    float peak = 0.0f;
+    for (auto i = 0; i < 22050; ++i)
+    {
+        auto y = filter.process (static_cast<float> (std::sin (2.0 * AudioMath::LD_PI * freq * i / sr)));
+        if (i > 11025)
+            peak = std::max (peak, std::abs (y));
+    }
+    return AudioMath::db (peak);
+}
+
+// the oversampled non linear stage through the FIR resamplers matches the filter without oversampling
+// q of 1 gives no feedback, so the resampler latency does not change the response
+static void testMoogFirResampler()
+{
+    const SynthFilter<float>::Type types[] = { SynthFilter<float>::Type::LPF2,
+                                               SynthFilter<float>::Type::LPF4,
+                                               SynthFilter<float>::Type::HPF2,
+                                               SynthFilter<float>::Type::HPF4 };
+    for (auto resampler : { sspo::Resampler::FIR_LINEAR, sspo::Resampler::FIR_MINIMUM })
+    {
+        for (auto type : types)
+        {
+            for (auto freq : { 250.0f, 1000.0f, 4000.0f })
+            {
+                auto expected = moogLadderGain (type, freq, false, resampler);
+                auto gain = moogLadderGain (type, freq, true, resampler);
+                assertClose (gain, expected, 0.1f);
+            }
+        }
+    }
+}
+
 static void testMoogBpPeak()
 {
     printf ("peak\n");
@@ -209,6 +268,7 @@ void testSynthFilter()
 {
     printf ("testSynthFilter\n");
     testMoogLPHP();
+    testMoogFirResampler();
     testMoogBpPeak();
 
 //impulse response tests to check for changes
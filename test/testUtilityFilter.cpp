@@ -32,6 +32,7 @@
 #include <assert.h>
 #include <stdio.h>
 #include <algorithm>
+#include <cmath>
 
 using float_4 = ::rack::simd::float_4;
 namespace ts = sspo::TestSignal;
@@ -581,6 +582,44 @@ static void testLWRCrossOverSmid4()
     }
 }
 
+// Crossover *************************
+
+static void testLWRCrossOverMatchesLp4Hp4 (float_4 fc, float_4 sr)
+{
+    LinkwitzRileyLP4<float_4> lp;
+    LinkwitzRileyHP4<float_4> hp;
+    LinkwitzRileyCrossover<float_4> crossover;
+    lp.setParameters (sr, fc);
+    hp.setParameters (sr, fc);
+    crossover.setParameters (sr, fc);
+
+    auto noise = ts::makeNoise (4096);
+    for (auto x : noise)
+    {
+        auto expectedLow = lp.process (x);
+        auto expectedHigh = hp.process (x);
+        float_4 low;
+        float_4 high;
+        crossover.process (x, low, high);
+        for (auto i = 0; i < 4; ++i)
+        {
+            // direct form biquads lose precision at low fc, the svf is the more accurate
+            assertClose (low[i], expectedLow[i], 2e-3f);
+            assertClose (high[i], expectedHigh[i], 2e-3f);
+        }
+    }
+}
+
+static void testLWRCrossOverShared()
+{
+    float_4 sr{ 44100, 44100, 44100, 44100 };
+    for (auto fc = 40.0f; fc < 18000.0f; fc += 500.0f)
+    {
+        float_4 fc_4 = { fc, fc + 100.0f, fc + 250.0f, fc + 400.0f };
+        testLWRCrossOverMatchesLp4Hp4 (fc_4, sr);
+    }
+}
+
 // ALLPASS *************************
 
 static void testAllPass (float fc, float sr)
@@ -687,6 +726,70 @@ static void testMixedBiquadSimd()
     assertClose (hp2slope.slope, -12.0f, 1.0f);
 }
 
+// SOS Cascade *********************
+
+static void testSOSCascadeMatchesBiquad()
+{
+    auto sr = 44100.0f;
+    BiQuad<float> lp;
+    BiQuad<float> hp;
+    lp.setButterworthLp2 (sr, 1200.0f);
+    hp.setButterworthHp2 (sr, 80.0f);
+
+    SOSCascade<float, 2> sos;
+    sos.setSection (0, lp);
+    sos.setSection (1, hp);
+
+    auto noise = ts::makeNoise (4096);
+    for (auto x : noise)
+    {
+        auto expected = hp.process (lp.process (x));
+        auto actual = sos.process (x);
+        assertClose (actual, expected, 1e-4f);
+    }
+}
+
+static void testSOSCascadeWetDry()
+{
+    BiQuad<float> allpass;
+    allpass.setAllPass1stOrder (44100.0f, 1000.0f);
+    allpass.setCoeffs (allpass.coeffs.a0, allpass.coeffs.a1, allpass.coeffs.a2, allpass.coeffs.b1, allpass.coeffs.b2, 0.5f, 0.5f);
+
+    SOSCascade<float, 1> sos;
+    sos.setSection (0, allpass);
+    sos.setWetDry (0.5f, 0.5f);
+
+    auto noise = ts::makeNoise (4096);
+    for (auto x : noise)
+    {
+        auto expected = allpass.process (x);
+        auto actual = sos.process (x);
+        assertClose (actual, expected, 1e-4f);
+    }
+}
+
+static void testSOSCascadeSimd()
+{
+    float_4 sr{ 44100.0f, 44100.0f, 48000.0f, 96000.0f };
+    float_4 fc{ 100.0f, 1000.0f, 5000.0f, 15000.0f };
+    BiQuad<float_4> f1;
+    BiQuad<float_4> f2;
+    f1.setButterworthLp2 (sr, fc);
+    f2.setButterworthLp2 (sr, fc);
+
+    SOSCascade<float_4, 2> sos;
+    sos.setButterworthLp2 (sr, fc);
+
+    auto noise = ts::makeNoise (4096);
+    for (auto x : noise)
+    {
+        auto expected = f2.process (f1.process (x));
+        auto actual = sos.process (x);
+        for (auto i = 0; i < 4; ++i)
+            assertClose (actual[i], expected[i], 1e-4f);
+    }
+}
+
 // Butterworth Tests *****************************
 static void testSlopeButterworthLp (const float cutoff,
                                     const float sr,
@@ -892,6 +995,184 @@ static void testButterworthLpSmid()
     }
 }
 
+static void testDcBlocker()
+{
+    const float sr = 44100.0f;
+    DcBlocker<float> dc;
+    DcBlocker<float_4> dc_4;
+    dc.setCutoff (sr, 5.5f);
+    dc_4.setCutoff (sr, 5.5f);
+
+    // a dc offset is removed, lanes match the scalar filter
+    float out = 0.0f;
+    for (auto i = 0; i < 44100; ++i)
+    {
+        out = dc.process (5.0f);
+        float_4 out_4 = dc_4.process (float_4 (5.0f, -5.0f, 0.0f, 2.5f));
+        assertClose (out_4[0], out, 1e-6f);
+        assertClose (out_4[1], -out, 1e-6f);
+        assertClose (out_4[3], out * 0.5f, 1e-6f);
+    }
+    // the float state stops converging when g * out is below its resolution
+    assertClose (out, 0.0f, 1e-3f);
+
+    // audio passes, and the corner is at the cutoff
+    for (auto freq : { 5.5f, 100.0f, 1000.0f })
+    {
+        dc.clear();
+        float peak = 0.0f;
+        for (auto i = 0; i < 88200; ++i)
+        {
+            auto y = dc.process (static_cast<float> (std::sin (2.0 * AudioMath::LD_PI * freq * i / sr)));
+            if (i > 44100)
+                peak = std::max (peak, std::abs (y));
+        }
+        auto level = AudioMath::db (peak);
+        auto expected = freq < 10.0f ? -3.0f : 0.0f;
+        assertClose (level, expected, 0.1f);
+    }
+}
+
+// peak level in dB of a sine at the oversampled rate after decimation
+template <int oversample>
+static float firDecimatedLevel (const float freq, const HalfBandDesign::Phase phase)
+{
+    FirDecimator<oversample, float> decimator (phase);
+    const float sr = 44100.0f * oversample;
+    float buffer[oversample];
+    float peak = 0.0f;
+    auto n = 0;
+    for (auto i = 0; i < 4096; ++i)
+    {
+        for (auto j = 0; j < oversample; ++j, ++n)
+            buffer[j] = static_cast<float> (std::sin (2.0 * AudioMath::LD_PI * freq * n / sr));
+        auto y = decimator.process (buffer);
+        if (i > 1024)
+            peak = std::max (peak, std::abs (y));
+    }
+    return AudioMath::db (peak);
+}
+
+template <int oversample>
+static void testFirDecimator (const HalfBandDesign::Phase phase)
+{
+    for (auto freq = 1000.0f; freq < 16000.0f; freq += 2500.0f)
+    {
+        auto level = firDecimatedLevel<oversample> (freq, phase);
+        assertClose (level, 0.0f, 0.1f);
+    }
+
+    // everything that would alias below 16kHz
+    auto worst = -200.0f;
+    for (auto freq = 28500.0f; freq < 22050.0f * oversample; freq += 1500.0f)
+        worst = std::max (worst, firDecimatedLevel<oversample> (freq, phase));
+#if 0
+    printf ("FIR decimator %dx %s stop band %f dB\n", oversample, phase == HalfBandDesign::Phase::LINEAR ? "linear" : "minimum", worst);
+#else
+    assertLT (worst, -75.0f);
+#endif
+}
+
+// a sine through the upsampler and back, is unchanged apart from the latency
+template <int oversample>
+static void testFirUpsampleDecimate (const float freq, const HalfBandDesign::Phase phase)
+{
+    FirUpsampler<oversample, float> up (phase);
+    FirDecimator<oversample, float> decimator (phase);
+
+    constexpr int fftSize = 1024 * 32;
+    auto s = ts::makeSine (fftSize, freq, 44100);
+    ts::Signal result;
+    float buffer[oversample];
+    float peak = 0.0f;
+    for (auto x : s)
+    {
+        up.process (x, buffer);
+        result.push_back (decimator.process (buffer));
+        if (result.size() > 1024)
+            peak = std::max (peak, std::abs (result.back()));
+    }
+
+    auto s_magnitude = FftAnalyzer::getMagnitude (ts::getResponse (s));
+    auto r_magnitude = FftAnalyzer::getMagnitude (ts::getResponse (result));
+    auto s_max_bin = std::distance (s_magnitude.begin(), std::max_element (s_magnitude.begin(), s_magnitude.end()));
+    auto r_max_bin = std::distance (r_magnitude.begin(), std::max_element (r_magnitude.begin(), r_magnitude.end()));
+    assertEQ (s_max_bin, r_max_bin);
+
+    auto sPeak = *std::max_element (s.begin(), s.end());
+    assertClose (peak, sPeak, 0.005f);
+}
+
+// the minimum phase design has the same response, with less latency
+static void testFirMinimumPhase()
+{
+    FirDecimator<2, float> linear (HalfBandDesign::Phase::LINEAR);
+    FirDecimator<2, float> minimum (HalfBandDesign::Phase::MINIMUM);
+
+    float linearPeak = 0.0f;
+    float minimumPeak = 0.0f;
+    auto linearPeakAt = 0;
+    auto minimumPeakAt = 0;
+    for (auto i = 0; i < 64; ++i)
+    {
+        float impulse[2] = { i == 0 ? 1.0f : 0.0f, 0.0f };
+        auto l = std::abs (linear.process (impulse));
+        auto m = std::abs (minimum.process (impulse));
+        if (l > linearPeak)
+        {
+            linearPeak = l;
+            linearPeakAt = i;
+        }
+        if (m > minimumPeak)
+        {
+            minimumPeak = m;
+            minimumPeakAt = i;
+        }
+    }
+    assertLT (minimumPeakAt + 4, linearPeakAt);
+}
+
+static void testFirSimd()
+{
+    FirDecimator<4, float> decimator;
+    FirDecimator<4, float_4> decimator_4;
+    FirUpsampler<4, float> up;
+    FirUpsampler<4, float_4> up_4;
+
+    float buffer[4];
+    float_4 buffer_4[4];
+    for (auto i = 0; i < 1000; ++i)
+    {
+        auto x = std::sin (i * 0.05f) + (i % 7) * 0.1f;
+        up.process (x, buffer);
+        up_4.process (float_4 (x, 0.0f, -x, 2.0f * x), buffer_4);
+        auto y = decimator.process (buffer);
+        auto y_4 = decimator_4.process (buffer_4);
+        assertClose (y_4[0], y, 1e-5f);
+        assertClose (y_4[1], 0.0f, 1e-5f);
+        assertClose (y_4[2], -y, 1e-5f);
+        assertClose (y_4[3], 2.0f * y, 1e-5f);
+    }
+}
+
+static void testFirResamplers()
+{
+    for (auto phase : { HalfBandDesign::Phase::LINEAR, HalfBandDesign::Phase::MINIMUM })
+    {
+        testFirDecimator<2> (phase);
+        testFirDecimator<4> (phase);
+        testFirDecimator<8> (phase);
+        for (auto freq : { 1000.0f, 10000.0f, 16000.0f })
+        {
+            testFirUpsampleDecimate<2> (freq, phase);
+            testFirUpsampleDecimate<4> (freq, phase);
+            testFirUpsampleDecimate<8> (freq, phase);
+        }
+    }
+    testFirMinimumPhase();
+    testFirSimd();
+}
+
 void testUtilityFilter()
 {
     printf ("Utility Filter\n");
@@ -914,4 +1195,10 @@ void testUtilityFilter()
     testButterworthLpSmid();
     testButterworthHpSmid();
     testUpsampleDecimator();
+    testSOSCascadeMatchesBiquad();
+    testSOSCascadeWetDry();
+    testSOSCascadeSimd();
+    testLWRCrossOverShared();
+    testFirResamplers();
+    testDcBlocker();
 }
\ No newline at end of file
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2020 Dave French <contact/dot/dave/dot/french3/at/googlemail/dot/com>
+ *
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public
+ * License as published by the Free Software Foundation; either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public
+ * License along with this program (see COPYING); if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <cmath>
+#include <vector>
+#include "asserts.h"
+
+#include "Wavetable.h"
+
+using float_4 = rack::simd::float_4;
+using namespace sspo;
+
+static float saw (const float phase)
+{
+    return 2.0f * phase - 1.0f;
+}
+
+/// magnitude of one frequency in a signal, as a fraction of full scale
+static float goertzel (const std::vector<float>& x, const float frequency, const float sampleRate)
+{
+    const auto w = 2.0 * static_cast<double> (AudioMath::LD_PI) * frequency / sampleRate;
+    const auto coefficient = 2.0 * std::cos (w);
+    double s1 = 0.0;
+    double s2 = 0.0;
+    for (auto v : x)
+    {
+        const auto s0 = v + coefficient * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    const auto power = s1 * s1 + s2 * s2 - coefficient * s1 * s2;
+    return static_cast<float> (2.0 * std::sqrt (std::max (power, 0.0)) / x.size());
+}
+
+/// each level holds the harmonics up to its limit and nothing above
+static void testLevels()
+{
+    MipmappedWavetable wavetable;
+    wavetable.setFunction (saw);
+
+    for (auto level = 0; level < MipmappedWavetable::levelCount; level += 2)
+    {
+        const auto maxHarmonic = MipmappedWavetable::tableSize >> (level + 1);
+        std::vector<float> cycle;
+        for (auto i = 0; i < MipmappedWavetable::tableSize; ++i)
+            cycle.push_back (wavetable.process (float_4 (static_cast<float> (i) / MipmappedWavetable::tableSize), float_4 (level))[0]);
+
+        // a saw's harmonics are 2 / (pi h)
+        const float size = MipmappedWavetable::tableSize;
+        assertClose (goertzel (cycle, 1.0f, size), 2.0f / AudioMath::k_pi, 0.01f);
+        // level 0 reaches the table's own Nyquist, there is nothing above it to check
+        if (level > 0 && maxHarmonic >= 4)
+        {
+            assertClose (goertzel (cycle, maxHarmonic, size), 2.0f / (AudioMath::k_pi * maxHarmonic), 0.01f);
+            assertLT (goertzel (cycle, maxHarmonic + 1.0f, size), 1e-4f);
+            assertLT (goertzel (cycle, maxHarmonic * 1.5f, size), 1e-4f);
+        }
+    }
+}
+
+/// a saw high enough that the naive version folds its upper harmonics back between the real ones
+static void testAliasFree()
+{
+    const auto sampleRate = 44100.0f;
+    const auto frequency = 3100.0f;
+    MipmappedWavetable wavetable;
+    wavetable.setFunction (saw);
+    WavetableOscillator oscillator;
+    oscillator.setWavetable (&wavetable);
+    oscillator.setFrequency (float_4 (frequency, frequency * 1.01f, frequency * 0.5f, 20.0f), 1.0f / sampleRate);
+
+    std::vector<float> out;
+    std::vector<float> naive;
+    auto phase = 0.0f;
+    for (auto i = 0; i < 44100; ++i)
+    {
+        out.push_back (oscillator.process()[0]);
+        naive.push_back (saw (phase));
+        phase += frequency / sampleRate;
+        phase -= std::floor (phase);
+    }
+
+    // the 8th harmonic at 24800Hz folds to 19300Hz
+    const auto alias = sampleRate - 8.0f * frequency;
+    assertGT (goertzel (naive, alias, sampleRate), 0.01f);
+    assertLT (goertzel (out, alias, sampleRate), 0.0005f);
+
+    assertClose (goertzel (out, frequency, sampleRate), 2.0f / AudioMath::k_pi, 0.01f);
+    // with one level per octave up to an octave below Nyquist is given up, the 4th harmonic at 12400Hz
+    // is kept, at least in part as the levels crossfade
+    assertGT (goertzel (out, 4.0f * frequency, sampleRate), 0.5f * 2.0f / (4.0f * AudioMath::k_pi));
+}
+
+static void testMipLevel()
+{
+    const float size = MipmappedWavetable::tableSize;
+    // at one cycle per table sample every harmonic is kept at level 0
+    float_4 level = MipmappedWavetable::mipLevel (float_4 (0.5f / size, -0.5f / size, 0.0f, 0.49f));
+    assertEQ (level[0], 0.0f);
+    assertEQ (level[1], 0.0f);
+    assertEQ (level[2], 0.0f);
+    assertEQ (level[3], static_cast<float> (MipmappedWavetable::levelCount - 1));
+
+    // one octave up moves one level
+    level = MipmappedWavetable::mipLevel (float_4 (4.0f / size, 8.0f / size, 6.0f / size, 1.0f));
+    assertClose (level[0], 3.0f, 1e-4f);
+    assertClose (level[1], 4.0f, 1e-4f);
+    assertClose (level[2], 3.0f + std::log2 (1.5f), 1e-4f);
+}
+
+void testWavetable()
+{
+    printf ("testWavetable\n");
+    testMipLevel();
+    testLevels();
+    testAliasFree();
+}